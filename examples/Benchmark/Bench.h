@@ -0,0 +1,221 @@
+#ifndef RING_BUFFER_BENCH_H
+#define RING_BUFFER_BENCH_H
+
+#include <RingBuffer.h>
+
+/**
+ * Cycle counter used for the measurements. Timer1 runs without a prescaler on AVR, and the DWT cycle counter is used
+ * on Cortex-M. Timer1 is 16 bits wide, so a single measurement has to stay under 65536 cycles.
+ */
+#if defined(__AVR__)
+   typedef uint16_t cycles_t;
+
+   static inline void benchInit(){
+      TCCR1A = 0;
+      TCCR1B = _BV(CS10);              //Timer1 counting CPU cycles, no prescaler.
+      TIMSK1 = 0;
+   }
+
+   static inline cycles_t benchNow(){
+      return TCNT1;
+   }
+#elif defined(DWT) && defined(CoreDebug)
+   typedef uint32_t cycles_t;
+
+   static inline void benchInit(){
+      CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+      DWT->CYCCNT = 0;
+      DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+   }
+
+   static inline cycles_t benchNow(){
+      return DWT->CYCCNT;
+   }
+#elif defined(ARDUINO_ARCH_ESP32)
+   typedef uint32_t cycles_t;
+
+   static inline void benchInit(){}
+
+   static inline cycles_t benchNow(){
+      return ESP.getCycleCount();
+   }
+#elif defined(__x86_64__) || defined(__i386__)
+   #include <x86intrin.h>
+   typedef uint64_t cycles_t;          //Time stamp counter ticks, for the host build in extras/test.
+
+   static inline void benchInit(){}
+
+   static inline cycles_t benchNow(){
+      return __rdtsc();
+   }
+#else
+   #warning "No cycle counter known for this architecture, estimating cycles from micros()."
+   typedef uint32_t cycles_t;
+
+   static inline void benchInit(){}
+
+   static inline cycles_t benchNow(){
+      return micros() * (F_CPU / 1000000UL);
+   }
+#endif
+
+volatile uint8_t benchSink;            //Keeps reads from being optimized away.
+
+/**
+ * Writes and reads one element, hiding the difference between the value specialization, which takes and returns
+ * copies, and the generic template, which takes and returns pointers.
+ */
+template<typename T, size_t N>
+inline void benchWrite(RingBuffer<T, 1, N> &rb, T const &v){
+   rb.write(v);
+}
+
+template<typename T, size_t N>
+inline void benchWrite(RingBuffer<T, 0, N> &rb, T const &v){
+   rb.write(&v);
+}
+
+template<typename T, size_t N>
+inline void benchPWrite(RingBuffer<T, 1, N> &rb, T const &v){
+   rb.p_write(v);
+}
+
+template<typename T, size_t N>
+inline void benchPWrite(RingBuffer<T, 0, N> &rb, T const &v){
+   rb.p_write(&v);
+}
+
+template<typename T, size_t N>
+inline void benchRead(RingBuffer<T, 1, N> &rb){
+   T item = rb.read();
+   benchSink = *(uint8_t *)&item;
+}
+
+template<typename T, size_t N>
+inline void benchRead(RingBuffer<T, 0, N> &rb){
+   benchSink = *(uint8_t *)rb.read();
+}
+
+template<typename T, size_t N>
+inline void benchPRead(RingBuffer<T, 1, N> &rb){
+   T item = rb.p_read();
+   benchSink = *(uint8_t *)&item;
+}
+
+template<typename T, size_t N>
+inline void benchPRead(RingBuffer<T, 0, N> &rb){
+   benchSink = *(uint8_t *)rb.p_read();
+}
+
+/**
+ * Prints text right aligned in a column of the given width.
+ */
+static void benchColumn(const char *text, uint8_t width){
+   for(uint8_t len = strlen(text); len < width; len++){
+      Serial.print(' ');
+   }
+   Serial.print(text);
+}
+
+/**
+ * Prints a whole number right aligned in a column of the given width.
+ */
+static void benchColumn(uint32_t value, uint8_t width){
+   char text[12];
+
+   snprintf(text, sizeof(text), "%lu", (unsigned long)value);
+   benchColumn(text, width);
+}
+
+/**
+ * Prints a value in tenths of a cycle, right aligned in a column of the given width.
+ */
+static void benchTenths(uint32_t tenths, uint8_t width){
+   char text[12];
+
+   snprintf(text, sizeof(text), "%lu.%lu", (unsigned long)(tenths / 10), (unsigned long)(tenths % 10));
+   benchColumn(text, width);
+}
+
+/**
+ * Cycles spent reading the counter twice, taken off every measurement.
+ */
+static cycles_t benchOverhead(){
+   cycles_t start = benchNow();
+   cycles_t stop = benchNow();
+   return stop - start;
+}
+
+/**
+ * Cycles since start, less the cost of reading the counter.
+ */
+static inline uint32_t benchSince(cycles_t start, cycles_t overhead){
+   cycles_t elapsed = benchNow() - start;
+   return (elapsed > overhead) ? elapsed - overhead : 0;
+}
+
+/**
+ * Times each API on a buffer filled to capacity and drained back to empty, then prints a row of cycles per element.
+ * The buffer is passed in so it can be declared static, keeping large buffers off of the stack.
+ */
+template<typename T, uint8_t value, size_t N>
+void benchRun(const char *name, RingBuffer<T, value, N> &rb){
+   static T block[N];
+   cycles_t overhead = benchOverhead();
+   cycles_t start;
+   uint32_t times[6];
+   T v;
+
+   memset(&v, 0x5A, sizeof(T));
+   memset(block, 0x5A, sizeof(block));
+
+   noInterrupts();                     //Keeps the timer ISRs out of the measurement.
+
+   start = benchNow();
+   for(size_t i = 0; i < N; i++){
+      benchWrite(rb, v);
+   }
+   times[0] = benchSince(start, overhead);
+
+   start = benchNow();
+   for(size_t i = 0; i < N; i++){
+      benchRead(rb);
+   }
+   times[1] = benchSince(start, overhead);
+
+   start = benchNow();
+   for(size_t i = 0; i < N; i++){
+      benchPWrite(rb, v);
+   }
+   times[2] = benchSince(start, overhead);
+
+   start = benchNow();
+   for(size_t i = 0; i < N; i++){
+      benchPRead(rb);
+   }
+   times[3] = benchSince(start, overhead);
+
+   start = benchNow();
+   rb.write(block, N);
+   times[4] = benchSince(start, overhead);
+
+   start = benchNow();
+   rb.read(block, N);
+   times[5] = benchSince(start, overhead);
+
+   interrupts();
+
+   Serial.print(name);
+   for(uint8_t len = strlen(name); len < 10; len++){
+      Serial.print(' ');
+   }
+   benchColumn(sizeof(T), 4);
+   benchColumn(N, 6);
+   benchColumn(RB_IS_POW2(N) ? "yes" : "no", 6);
+   for(uint8_t i = 0; i < 6; i++){
+      benchTenths(times[i] * 10 / N, 9);
+   }
+   Serial.println();
+}
+
+#endif
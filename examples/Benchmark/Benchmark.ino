@@ -0,0 +1,51 @@
+/**
+ * Measures the cycles per element taken by each RingBuffer API, and prints them as a table over Serial.
+ *
+ * Covers the value specialization (elements of up to 2 bytes) and the generic template, power of two and other
+ * capacities. Cycles are counted with Timer1 on AVR and the DWT cycle counter on Cortex-M. Each figure includes the
+ * loop around the call, so compare figures between builds rather than reading them as absolute costs.
+ *
+ * The table can be captured and compared against a baseline with extras/benchmark/bench_compare.py.
+ */
+#include "Bench.h"
+
+struct Sample{
+   uint32_t time;
+   int16_t x;
+   int16_t y;
+};
+
+RingBuffer<uint8_t, 1, 16> u8Pow2;
+RingBuffer<uint8_t, 1, 15> u8Odd;
+RingBuffer<uint8_t, 1, 64> u8Large;
+RingBuffer<uint16_t, 1, 32> u16Pow2;
+RingBuffer<uint16_t, 1, 30> u16Odd;
+RingBuffer<uint32_t, 0, 16> u32Pow2;
+RingBuffer<uint32_t, 0, 15> u32Odd;
+RingBuffer<Sample, 0, 16> samplePow2;
+RingBuffer<Sample, 0, 15> sampleOdd;
+
+void setup(){
+   Serial.begin(115200);
+   while(!Serial);
+
+   benchInit();
+
+   Serial.println(F("RingBuffer benchmark, cycles per element"));
+   Serial.println(F("type      size     N  pow2    write     read  p_write   p_read   bulk_w   bulk_r"));
+
+   benchRun("uint8_t", u8Pow2);
+   benchRun("uint8_t", u8Odd);
+   benchRun("uint8_t", u8Large);
+   benchRun("uint16_t", u16Pow2);
+   benchRun("uint16_t", u16Odd);
+   benchRun("uint32_t", u32Pow2);
+   benchRun("uint32_t", u32Odd);
+   benchRun("Sample", samplePow2);
+   benchRun("Sample", sampleOdd);
+
+   Serial.println(F("done"));
+}
+
+void loop(){
+}
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""
+Captures the table printed by examples/Benchmark and compares it against a saved baseline.
+
+   bench_compare.py --port /dev/ttyUSB0 --save baseline.txt     Capture a run and keep it as the baseline.
+   bench_compare.py --port /dev/ttyUSB0 --baseline baseline.txt Capture a run and compare it against the baseline.
+   bench_compare.py --input run.txt --baseline baseline.txt     Compare an already captured run.
+
+Exits with 1 when any figure is slower than the baseline by more than the tolerance, so it can gate a firmware build.
+Reading from a serial port needs pyserial.
+"""
+
+import argparse
+import sys
+
+COLUMNS = ["write", "read", "p_write", "p_read", "bulk_w", "bulk_r"]
+
+
+def capture(port, baud):
+    import serial
+
+    lines = []
+    with serial.Serial(port, baud, timeout=30) as link:
+        while True:
+            line = link.readline().decode("ascii", "replace").strip()
+            if not line or line == "done":
+                break
+            lines.append(line)
+    return lines
+
+
+def parse(lines):
+    """Returns {(type, size, N): {column: cycles}} for every row of the table."""
+    rows = {}
+    for line in lines:
+        fields = line.split()
+        if len(fields) != 4 + len(COLUMNS) or not fields[1].isdigit():
+            continue
+        key = (fields[0], int(fields[1]), int(fields[2]))
+        rows[key] = dict(zip(COLUMNS, (float(f) for f in fields[4:])))
+    return rows
+
+
+def compare(run, baseline, tolerance):
+    regressions = 0
+    for key in sorted(baseline):
+        if key not in run:
+            print("missing   %-10s size %-3d N %-5d" % key)
+            regressions += 1
+            continue
+        for column in COLUMNS:
+            old = baseline[key][column]
+            new = run[key][column]
+            if old > 0 and (new - old) / old > tolerance:
+                print("slower    %-10s size %-3d N %-5d %-8s %7.1f -> %7.1f" % (key + (column, old, new)))
+                regressions += 1
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", help="serial port the benchmark sketch is running on")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--input", help="read a captured table from a file instead of a serial port")
+    parser.add_argument("--baseline", help="table to compare the run against")
+    parser.add_argument("--save", help="write the captured table to this file")
+    parser.add_argument("--tolerance", type=float, default=0.05, help="allowed slowdown, 0.05 being 5%%")
+    args = parser.parse_args()
+
+    if args.input:
+        with open(args.input) as f:
+            lines = [line.strip() for line in f]
+    elif args.port:
+        lines = capture(args.port, args.baud)
+    else:
+        parser.error("either --port or --input is needed")
+
+    for line in lines:
+        print(line)
+
+    if args.save:
+        with open(args.save, "w") as f:
+            f.write("\n".join(lines) + "\n")
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = parse(f)
+        regressions = compare(parse(lines), baseline, args.tolerance)
+        print("%d regression(s)" % regressions)
+        return 1 if regressions else 0
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
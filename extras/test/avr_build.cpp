@@ -0,0 +1,34 @@
+/**
+ * Compiled, not run, by the avr_build test when avr-g++ is found: a plain avr-gcc build without the Arduino core, so
+ * the headers are checked against the AVR compiler and its own includes.
+ */
+#include "RingBuffer.h"
+#include "MultiRingBuffer.h"
+#include "MessageRingBuffer.h"
+
+RingBuffer<uint8_t, 1, 16> bytes;
+RingBuffer<uint8_t, 1, 128> wide;
+RingBuffer<uint16_t, 1, 200> words;
+RingBuffer<uint32_t, 0, 10, ReturnError> longs;
+MessageRingBuffer<64> messages;
+uint8_t store[200];
+RingBuffer<uint8_t> runtime(store, sizeof(store));
+volatile uint8_t port;
+
+int main(){
+   uint8_t i = 0;
+   uint32_t v = 0;
+
+   for(;;){
+      bytes.p_write(port);
+      wide.p_write(bytes.p_read());
+      words.p_write(wide.p_read() + i++);
+      longs.emplace((uint32_t)words.p_read());
+      if(longs.pop(v)){
+         messages.writeMessage((uint8_t const *)&v, sizeof(v));
+      }
+      port = messages.readMessage((uint8_t *)&v, sizeof(v));
+      runtime.p_write(port);
+      port = runtime.p_read();
+   }
+}
@@ -0,0 +1,233 @@
+/**
+ * Host counterpart of examples/Benchmark: millions of elements per second through each read and write API, for both
+ * specializations and for power of two and other capacities, then the same paths with the producer and consumer on
+ * two threads. Figures depend on the host and are only meant for comparing two builds on the same machine.
+ *
+ * Each column writes half the capacity and reads it back: write() and read(), p_write() and p_read(), emplace() and
+ * pop(), write(src, n) and read(dst, n), and reserve() and commit() against peek() and consume().
+ *
+ *    bench                   Runs every figure for about 20 ms each.
+ *    bench 200               Runs each for 200 ms instead.
+ */
+#include <chrono>
+#include <thread>
+
+#include "RingBuffer.h"
+#include "MPMCRingBuffer.h"
+#if defined(__linux__)
+   #include "MirrorRingBuffer.h"
+#endif
+
+#include "check.h"
+
+static double runMs = 20;              //How long each figure is measured for.
+static volatile uint32_t sink;         //Keeps the compiler from dropping what was read.
+
+/**
+ * Calls pass repeatedly for runMs and returns millions of elements per second, pass moving per elements each call.
+ */
+template<typename F>
+static double rate(size_t per, F pass){
+   typedef std::chrono::steady_clock clock;
+   clock::time_point start = clock::now();
+   double elapsed = 0;
+   size_t calls = 0;
+
+   while(elapsed < runMs / 1000){
+      for(int i = 0; i < 64; i++){
+         pass();
+      }
+      calls += 64;
+      elapsed = std::chrono::duration<double>(clock::now() - start).count();
+   }
+
+   return calls * per / elapsed / 1e6;
+}
+
+static void column(double mops){
+   printf(" %8.1f", mops);
+}
+
+/**
+ * One row of the table: a block of the buffer's capacity written and read back through each API in turn.
+ */
+template<typename T, uint8_t value, size_t N>
+static void row(char const *name){
+   static RingBuffer<T, value, N> rb;
+   static T block[N];
+   const size_t half = N / 2;
+
+   printf("%-9s %4zu %5zu %5s", name, sizeof(T), N, RB_IS_POW2(N) ? "yes" : "no");
+
+   column(rate(2 * half, [&]{
+      T v = (T)1;
+      for(size_t i = 0; i < half; i++){
+         if constexpr(value){
+            rb.write(v);
+         }else{
+            rb.write(&v);
+         }
+      }
+      for(size_t i = 0; i < half; i++){
+         if constexpr(value){
+            sink += (uint32_t)rb.read();
+         }else{
+            sink += (uint32_t)*rb.read();
+         }
+      }
+   }));
+
+   column(rate(2 * half, [&]{
+      T v = (T)1;
+      for(size_t i = 0; i < half; i++){
+         if constexpr(value){
+            rb.p_write(v);
+         }else{
+            rb.p_write(&v);
+         }
+      }
+      for(size_t i = 0; i < half; i++){
+         if constexpr(value){
+            sink += (uint32_t)rb.p_read();
+         }else{
+            sink += (uint32_t)*rb.p_read();
+         }
+      }
+   }));
+
+   column(rate(2 * half, [&]{
+      for(size_t i = 0; i < half; i++){
+         rb.emplace((T)i);
+      }
+      T v = T();
+      for(size_t i = 0; i < half; i++){
+         rb.pop(v);
+         sink += (uint32_t)v;
+      }
+   }));
+
+   column(rate(2 * half, [&]{
+      rb.write(block, half);
+      rb.read(block, half);
+      sink += (uint32_t)block[0];
+   }));
+
+   column(rate(2 * half, [&]{
+      size_t left = half;
+      while(left){
+         typename RingBuffer<T, value, N>::span s = rb.reserve(left);
+         for(size_t i = 0; i < s.length; i++){
+            s.addr[i] = (T)i;
+         }
+         rb.commit(s.length);
+         left -= s.length;
+      }
+      left = half;
+      while(left){
+         typename RingBuffer<T, value, N>::span s = rb.peek();
+         size_t n = (s.length > left) ? left : s.length;
+         for(size_t i = 0; i < n; i++){
+            sink += (uint32_t)s.addr[i];
+         }
+         rb.consume(n);
+         left -= n;
+      }
+   }));
+
+   printf("\n");
+}
+
+/**
+ * Elements per second with a producer and a consumer thread on p_write()/p_read() and on the bulk calls.
+ */
+template<size_t N>
+static void threaded(){
+   typedef std::chrono::steady_clock clock;
+   const size_t count = 2000000 * (size_t)(runMs / 20 < 1 ? 1 : runMs / 20);
+   static RingBuffer<uint32_t, 0, N, ReturnError> rb;
+
+   clock::time_point start = clock::now();
+   std::thread p([&]{
+      for(size_t i = 0; i < count; i++){
+         uint32_t v = (uint32_t)i;
+         while(rb.size() >= N - 1){
+            std::this_thread::yield();
+         }
+         rb.p_write(&v);
+      }
+   });
+   for(size_t i = 0; i < count; i++){
+      while(rb.isEmpty()){
+         std::this_thread::yield();
+      }
+      sink += *rb.p_read();
+   }
+   p.join();
+   printf("two threads, p_write/p_read, N %4zu %8.1f\n", N,
+          count / std::chrono::duration<double>(clock::now() - start).count() / 1e6);
+
+   start = clock::now();
+   std::thread q([&]{
+      uint32_t src[64] = {0};
+      size_t i = 0;
+      while(i < count){
+         size_t n = rb.write(src, (count - i < 64) ? count - i : 64);
+         i += n;
+         if(!n){
+            std::this_thread::yield();
+         }
+      }
+   });
+   uint32_t dst[64];
+   for(size_t i = 0; i < count;){
+      size_t n = rb.read(dst, 64);
+      i += n;
+      if(!n){
+         std::this_thread::yield();
+      }
+   }
+   q.join();
+   printf("two threads, bulk 64,        N %4zu %8.1f\n", N,
+          count / std::chrono::duration<double>(clock::now() - start).count() / 1e6);
+}
+
+int main(int argc, char **argv){
+   if(argc > 1){
+      runMs = atof(argv[1]);
+   }
+
+   printf("Millions of elements per second, one thread\n");
+   printf("type      size     N  pow2    write  p_write  emplace     bulk     span\n");
+   row<uint8_t, 1, 64>("uint8_t");
+   row<uint8_t, 1, 100>("uint8_t");
+   row<int16_t, 1, 64>("int16_t");
+   row<uint32_t, 0, 64>("uint32_t");
+   row<uint32_t, 0, 100>("uint32_t");
+   row<uint64_t, 0, 256>("uint64_t");
+
+   static MPMCRingBuffer<uint32_t, 64> mpmc;
+   printf("MPMCRingBuffer write/read, N 64 %8.1f\n", rate(64, [&]{
+      for(uint32_t i = 0; i < 32; i++){
+         mpmc.write(i);
+      }
+      uint32_t v = 0;
+      for(int i = 0; i < 32; i++){
+         mpmc.read(v);
+         sink += v;
+      }
+   }));
+#if defined(__linux__)
+   MirrorRingBuffer<uint32_t> mirror(4096);
+   static uint32_t block[1024];
+   printf("MirrorRingBuffer bulk 1024    %8.1f\n", rate(2048, [&]{
+      mirror.write(block, 1024);
+      mirror.read(block, 1024);
+   }));
+#endif
+
+   printf("\n");
+   threaded<64>();
+   threaded<1024>();
+
+   return 0;
+}
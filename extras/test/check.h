@@ -0,0 +1,53 @@
+#ifndef RING_TEST_CHECK_H
+#define RING_TEST_CHECK_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * The few pieces the host tests share: a CHECK() that reports the failing line and keeps going, and a small seeded
+ * generator so every run of a test makes the same calls.
+ */
+static unsigned long ringFailures = 0;
+
+#define CHECK(cond)     do{ if(!(cond)){ ringFail(__FILE__, __LINE__, #cond); } }while(0)
+
+inline void ringFail(char const *file, int line, char const *what){
+   fprintf(stderr, "%s:%d: failed: %s\n", file, line, what);
+   if(++ringFailures >= 25){
+      fprintf(stderr, "Too many failures, stopping.\n");
+      exit(1);
+   }
+}
+
+/**
+ * Returns the exit code of a test: 0 when every CHECK() passed.
+ */
+inline int ringResult(char const *name){
+   printf("%s: %s\n", name, ringFailures ? "FAILED" : "ok");
+   return ringFailures ? 1 : 0;
+}
+
+/**
+ * xorshift64*, enough to drive random calls and values.
+ */
+struct ringRandom{
+   uint64_t state;
+
+   ringRandom(uint64_t seed) : state(seed * 2654435761u + 1){
+   }
+
+   inline uint64_t next(){
+      state ^= state >> 12;
+      state ^= state << 25;
+      state ^= state >> 27;
+      return state * 2685821657736338717ull;
+   }
+
+   inline size_t below(size_t n){
+      return (size_t)(next() % n);
+   }
+};
+
+#endif
@@ -0,0 +1,1517 @@
+/**
+ * Randomized tests of every buffer against a reference queue. Each test runs a long seeded mix of the buffer's calls,
+ * does the same to a std::deque, and checks every return value, element and index against it, including what the
+ * overflow policies and the empty reads give back.
+ *
+ * Built several times by CMakeLists.txt: as is; with RB_WATERMARKS, RB_STATS and RB_SNAPSHOT defined, which also
+ * checks the hooks against the same reference; with RB_OPTIMIZE_SIZE; and with RB_WORD_COPY=1, for the word copy loop
+ * the host otherwise leaves out.
+ */
+#include <deque>
+#include <string>
+#include <vector>
+#include <type_traits>
+#include <utility>
+
+#include "RingBuffer.h"
+#include "BitRingBuffer.h"
+#include "WindowRingBuffer.h"
+#include "MultiRingBuffer.h"
+#include "MessageRingBuffer.h"
+#include "PriorityRingSet.h"
+#include "DeltaEncoder.h"
+#include "DmaRingBuffer.h"
+#include "FlashRingBuffer.h"
+#include "MPMCRingBuffer.h"
+#include "RingPipeline.h"
+
+static uint32_t traceNow = 0;          //A clock for the trace ring that moves by a known step per record.
+#define RB_TRACE_CLOCK()       (traceNow += 3)
+#define RB_TRACE_UNLOCKED              //Recorded from a single thread.
+#include "TraceRingBuffer.h"
+#if defined(__linux__)
+   #include "MirrorRingBuffer.h"
+#endif
+
+#include "check.h"
+
+static const size_t steps = 20000;     //Random calls per buffer.
+
+/**
+ * An element larger than a pointer, with padding, for the pointer specialization.
+ */
+struct triple{
+   uint32_t a;
+   uint16_t b;
+   uint8_t c;
+
+   inline bool operator==(triple const &o) const{
+      return a == o.a && b == o.b && c == o.c;
+   }
+};
+
+template<typename T>
+inline T sample(ringRandom &rng){
+   T v;
+   uint64_t x = rng.next();
+
+   memcpy(&v, &x, sizeof(T) < sizeof(x) ? sizeof(T) : sizeof(x));
+   return v;
+}
+
+/**
+ * Calls the value or the pointer flavour of p_write(), write() and the reads, whichever the buffer has.
+ */
+template<typename B>
+constexpr bool byValue(){
+   return !std::is_pointer<decltype(std::declval<B &>().p_read())>::value;
+}
+
+template<typename B, typename T>
+inline auto pWrite(B &rb, T const &v){
+   if constexpr(byValue<B>()){
+      return rb.p_write(v);
+   }else{
+      return rb.p_write(&v);
+   }
+}
+
+template<typename B, typename T>
+inline auto write(B &rb, T const &v){
+   if constexpr(byValue<B>()){
+      return rb.write(v);
+   }else{
+      return rb.write(&v);
+   }
+}
+
+template<typename T, typename B>
+inline T pRead(B &rb){
+   if constexpr(byValue<B>()){
+      return rb.p_read();
+   }else{
+      return *rb.p_read();
+   }
+}
+
+template<typename T, typename B>
+inline T read(B &rb){
+   if constexpr(byValue<B>()){
+      return rb.read();
+   }else{
+      return *rb.read();
+   }
+}
+
+/**
+ * Runs every RingBuffer call against the reference, len being the buffer's capacity and P its policy.
+ */
+template<typename P, typename T, typename B>
+static void fuzzCore(B &rb, size_t len, uint64_t seed){
+   typedef decltype(rb.size()) I;
+   std::deque<T> ref;
+   std::vector<T> buf(len + 3);
+   ringRandom rng(seed);
+   size_t written = 0;                 //Elements ever stored, so the write index sits at slot written % len.
+   T last = T();                       //The last element read, which an empty p_read() hands back again.
+   uint8_t hasLast = 0;
+
+#if defined(RB_STATS)
+   size_t maxUsed = 0;
+   uint32_t dropped = 0;
+   uint32_t emptyReads = 0;
+#endif
+#if defined(RB_WATERMARKS)
+   I high = (I)(1 + rng.below(len));
+   I low = (I)rng.below(len);
+   uint8_t highHit = 0;
+   uint8_t lowHit = 0;
+
+   rb.setWatermarks(high, low);
+#endif
+
+   auto stored = [&](size_t before){
+      (void)before;
+#if defined(RB_STATS)
+      if(ref.size() > maxUsed){
+         maxUsed = ref.size();
+      }
+#endif
+#if defined(RB_WATERMARKS)
+      if(before < high && ref.size() >= high){
+         highHit = 1;
+      }
+#endif
+   };
+
+   auto removed = [&](size_t before){
+      (void)before;
+#if defined(RB_WATERMARKS)
+      if(before > low && ref.size() <= low){
+         lowHit = 1;
+      }
+#endif
+   };
+
+   auto missed = [&](){
+#if defined(RB_STATS)
+      emptyReads++;
+#endif
+   };
+
+   //What the policy does with a single write that returned ret, for a buffer that was full or not.
+   auto policy = [&](I ret, T const &v, uint8_t wasFull){
+      if(!wasFull){
+         ref.push_back(v);
+         written++;
+         CHECK(ret == written % len);
+         stored(ref.size() - 1);
+         return;
+      }
+#if defined(RB_STATS)
+      dropped++;
+#endif
+      if(P::onFull == RB_OVERWRITE){
+         ref.pop_front();
+         ref.push_back(v);
+         written++;
+         CHECK(ret == written % len);
+         stored(len - 1);               //Dropped and stored again, as the buffer sees it.
+      }else if(P::onFull == RB_DROP){
+         CHECK(ret == written % len);
+      }else{
+         CHECK(ret == B::writeError);
+      }
+   };
+
+   for(size_t step = 0; step < steps; step++){
+      uint8_t full = ref.size() == len;
+      uint8_t empty = ref.empty();
+      size_t before = ref.size();
+      T v = sample<T>(rng);
+
+      switch(rng.below(14)){
+         case 0:{
+            I ret = pWrite(rb, v);
+            if(full){
+#if defined(RB_STATS)
+               dropped++;
+#endif
+               CHECK(ret == written % len);
+            }else{
+               policy(ret, v, 0);
+            }
+            break;
+         }
+
+         case 1:
+            if(!(full && P::onFull == RB_BLOCK)){
+               policy(write(rb, v), v, full);
+            }
+            break;
+
+         case 2:
+            if(!(full && P::onFull == RB_BLOCK)){
+               policy(rb.emplace(v), v, full);
+            }
+            break;
+
+         case 3:
+            if(!(full && P::onFull == RB_BLOCK)){
+               policy(rb.push(T(v)), v, full);
+            }
+            break;
+
+         case 4:{
+            T got = pRead<T>(rb);
+            if(empty){
+               missed();
+               if(hasLast){
+                  CHECK(got == last);
+               }
+            }else{
+               CHECK(got == ref.front());
+               last = got;
+               hasLast = 1;
+               ref.pop_front();
+               removed(before);
+            }
+            break;
+         }
+
+         case 5:{
+            T got = read<T>(rb);
+            if(empty){
+               missed();
+            }else{
+               CHECK(got == ref.front());
+               last = got;
+               hasLast = 1;
+               ref.pop_front();
+               removed(before);
+            }
+            break;
+         }
+
+         case 6:{
+            T got = v;
+            uint8_t ret = rb.pop(got);
+            CHECK(ret == !empty);
+            if(empty){
+               missed();
+               CHECK(got == v);
+            }else{
+               CHECK(got == ref.front());
+               last = got;
+               hasLast = 1;
+               ref.pop_front();
+               removed(before);
+            }
+            break;
+         }
+
+         case 7:{
+            size_t n = rng.below(len + 3);
+            size_t space = len - before;
+            for(size_t i = 0; i < n; i++){
+               buf[i] = sample<T>(rng);
+            }
+            size_t ret = rb.write(buf.data(), n);
+            CHECK(ret == (n < space ? n : space));
+            for(size_t i = 0; i < ret; i++){
+               ref.push_back(buf[i]);
+            }
+            written += ret;
+#if defined(RB_STATS)
+            dropped += (n > space) ? n - space : 0;
+#endif
+            stored(before);
+            break;
+         }
+
+         case 8:{
+            size_t n = rng.below(len + 3);
+            size_t ret = rb.read(buf.data(), n);
+            CHECK(ret == (n < before ? n : before));
+            if(n > before && before == 0){
+               missed();
+            }
+            for(size_t i = 0; i < ret; i++){
+               CHECK(buf[i] == ref.front());
+               last = ref.front();
+               hasLast = 1;
+               ref.pop_front();
+            }
+            removed(before);
+            break;
+         }
+
+         case 9:{
+            size_t n = rng.below(len + 2);
+            size_t toEnd = len - written % len;
+            size_t expect = (n < len - before) ? n : len - before;
+            typename B::span s = rb.reserve((I)n);
+            CHECK(s.length == (expect < toEnd ? expect : toEnd));
+            size_t k = rng.below((size_t)s.length + 1);
+            for(size_t i = 0; i < k; i++){
+               s.addr[i] = sample<T>(rng);
+               ref.push_back(s.addr[i]);
+            }
+            rb.commit((I)k);
+            written += k;
+            stored(before);
+            break;
+         }
+
+         case 10:{
+            size_t toEnd = len - (written - before) % len;
+            typename B::span s = rb.peek();
+            CHECK(s.length == (before < toEnd ? before : toEnd));
+            for(size_t i = 0; i < s.length && i < before; i++){
+               CHECK(s.addr[i] == ref[i]);
+            }
+            size_t k = rng.below((size_t)s.length + 1);
+            for(size_t i = 0; i < k; i++){
+               last = ref.front();
+               hasLast = 1;
+               ref.pop_front();
+            }
+            rb.consume((I)k);
+            removed(before);
+            break;
+         }
+
+         case 11:
+            if constexpr(std::is_arithmetic<T>::value){
+               std::vector<double> out(len + 3);
+               size_t n = rng.below(len + 3);
+               size_t ret = rb.read(out.data(), n, [](T x){ return (double)x * 2; });
+               CHECK(ret == (n < before ? n : before));
+               if(n > before && before == 0){
+                  missed();
+               }
+               for(size_t i = 0; i < ret; i++){
+                  CHECK(out[i] == (double)ref.front() * 2);
+                  last = ref.front();
+                  hasLast = 1;
+                  ref.pop_front();
+               }
+               removed(before);
+            }
+            break;
+
+         case 12:{
+            CHECK(rb.size() == before);
+            CHECK(rb.isEmpty() == empty);
+            CHECK(rb.isFull() == full);
+            if(!empty){
+               size_t i = rng.below(before);
+               CHECK(rb[(I)i] == ref[i]);
+            }
+            size_t i = 0;
+            for(T const &x : rb){
+               CHECK(i < before && x == ref[i]);
+               i++;
+            }
+            CHECK(i == before);
+            break;
+         }
+
+         case 13:{
+#if defined(RB_SNAPSHOT)
+            size_t n = rng.below(len + 2);
+            size_t k = (before < len) ? before : len - 1;
+            if(n < k){
+               k = n;
+            }
+            CHECK(rb.snapshotLatest(buf.data(), n) == k);
+            for(size_t i = 0; i < k; i++){
+               CHECK(buf[i] == ref[before - k + i]);
+            }
+            CHECK(rb.size() == before);
+#endif
+            break;
+         }
+      }
+
+#if defined(RB_WATERMARKS)
+      CHECK(rb.reachedHigh() == highHit);
+      CHECK(rb.reachedLow() == lowHit);
+      highHit = 0;
+      lowHit = 0;
+#endif
+   }
+
+#if defined(RB_STATS)
+   ringStats<I> s = rb.stats();
+   CHECK(s.maxUsed == maxUsed);
+   CHECK(s.dropped == dropped);
+   CHECK(s.emptyReads == emptyReads);
+   CHECK(s.moved == (uint32_t)written);
+#endif
+}
+
+/**
+ * The same buffer type with its array inside the object, at compile-time capacity N.
+ */
+template<typename T, uint8_t value, size_t N, typename P>
+static void fuzzFixed(uint64_t seed){
+   static RingBuffer<T, value, N, P> rb;
+   rb = RingBuffer<T, value, N, P>();
+   fuzzCore<P, T>(rb, N, seed);
+}
+
+/**
+ * The array handed over at runtime, with I as the index type.
+ */
+template<typename T, uint8_t value, typename P, typename I>
+static void fuzzRuntime(size_t len, uint64_t seed){
+   std::vector<T> arr(len);
+   RingBuffer<T, value, 0, P, I> rb(arr.data(), (I)len);
+   fuzzCore<P, T>(rb, len, seed);
+}
+
+template<typename P>
+static void fuzzPolicy(uint64_t seed){
+   fuzzFixed<uint8_t, 1, 8, P>(seed);
+   fuzzFixed<uint8_t, 1, 7, P>(seed + 1);
+   fuzzFixed<int16_t, 1, 1, P>(seed + 2);
+   fuzzFixed<int16_t, 1, 100, P>(seed + 3);
+   fuzzFixed<uint8_t, 0, 16, P>(seed + 4);
+   fuzzFixed<uint32_t, 0, 32, P>(seed + 5);
+   fuzzFixed<triple, 0, 10, P>(seed + 6);
+   fuzzRuntime<uint8_t, 1, P, uint8_t>(5, seed + 7);
+   fuzzRuntime<int16_t, 1, P, uint16_t>(200, seed + 8);
+   fuzzRuntime<triple, 0, P, uint16_t>(64, seed + 9);
+   fuzzRuntime<uint32_t, 0, P, size_t>(13, seed + 10);
+}
+
+/**
+ * An element with a lifetime, counting how many are alive so a missed or doubled destructor shows up.
+ */
+struct tracked{
+   static long live;
+   std::string text;
+
+   tracked() : text(){
+      live++;
+   }
+   tracked(std::string const &s) : text(s){
+      live++;
+   }
+   tracked(tracked const &o) : text(o.text){
+      live++;
+   }
+   tracked(tracked &&o) : text(std::move(o.text)){
+      live++;
+   }
+   tracked &operator=(tracked const &o){
+      text = o.text;
+      return *this;
+   }
+   tracked &operator=(tracked &&o){
+      text = std::move(o.text);
+      return *this;
+   }
+   ~tracked(){
+      live--;
+   }
+};
+
+long tracked::live = 0;
+
+/**
+ * The calls that take non-trivial elements, checked against the reference and against the number alive. With counted
+ * set only the used slots hold a live element; an array handed over at runtime stays alive as a whole.
+ */
+template<typename P, typename B>
+static void fuzzObjects(B &rb, size_t len, uint8_t counted, uint64_t seed){
+   typedef decltype(rb.size()) I;
+   std::deque<std::string> ref;
+   ringRandom rng(seed);
+   long base = tracked::live;
+
+   for(size_t step = 0; step < steps; step++){
+      size_t before = ref.size();
+      std::string text = std::to_string(rng.next());       //Long enough to live on the heap.
+
+      switch(rng.below(6)){
+         case 0:
+         case 1:{
+            I ret = (step & 1) ? rb.emplace(text) : rb.push(tracked(text));
+            if(before < len){
+               ref.push_back(text);
+            }else if(P::onFull == RB_OVERWRITE){
+               ref.pop_front();
+               ref.push_back(text);
+            }else if(P::onFull == RB_ERROR){
+               CHECK(ret == B::writeError);
+            }
+            break;
+         }
+
+         case 2:{
+            tracked got;
+            CHECK(rb.pop(got) == (before != 0));
+            if(before){
+               CHECK(got.text == ref.front());
+               ref.pop_front();
+            }
+            break;
+         }
+
+         case 3:{
+            size_t n = rng.below(len + 2);
+            std::vector<tracked> src;
+            for(size_t i = 0; i < n; i++){
+               src.push_back(tracked(std::to_string(rng.next())));
+            }
+            size_t ret = rb.write(src.data(), n);
+            CHECK(ret == (n < len - before ? n : len - before));
+            for(size_t i = 0; i < ret; i++){
+               ref.push_back(src[i].text);
+            }
+            break;
+         }
+
+         case 4:{
+            size_t n = rng.below(len + 2);
+            std::vector<tracked> dst(n);
+            size_t ret = rb.read(dst.data(), n);
+            CHECK(ret == (n < before ? n : before));
+            for(size_t i = 0; i < ret; i++){
+               CHECK(dst[i].text == ref.front());
+               ref.pop_front();
+            }
+            break;
+         }
+
+         case 5:{
+            typename B::span s = rb.peek();
+            size_t k = rng.below((size_t)s.length + 1);
+            for(size_t i = 0; i < s.length; i++){
+               CHECK(s.addr[i].text == ref[i]);
+            }
+            for(size_t i = 0; i < k; i++){
+               ref.pop_front();
+            }
+            rb.consume((I)k);
+            break;
+         }
+      }
+
+      CHECK(rb.size() == ref.size());
+      CHECK(tracked::live - base == (counted ? (long)ref.size() : 0));
+      if(!ref.empty()){
+         size_t i = rng.below(ref.size());
+         CHECK(rb[(I)i].text == ref[i]);
+      }
+   }
+}
+
+/**
+ * Runtime capacities use the whole array up to maxLength, and only that much of a longer one.
+ */
+template<typename I>
+static void fuzzLength(size_t elements, size_t expected){
+   static uint8_t store[300];
+   RingBuffer<uint8_t, 1, 0, OverwriteOldest, I> rb(store, (I)elements);
+
+   for(size_t i = 0; i < elements && !rb.isFull(); i++){
+      rb.p_write((uint8_t)i);
+   }
+   CHECK(rb.isFull());
+   CHECK(rb.size() == expected);
+   for(size_t i = 0; i < expected; i++){
+      CHECK(rb.p_read() == (uint8_t)i);
+   }
+   CHECK(rb.isEmpty());
+}
+
+static void fuzzLifetimes(uint64_t seed){
+   {
+      RingBuffer<tracked, 0, 6, ReturnError> rb;
+      fuzzObjects<ReturnError>(rb, 6, 1, seed);
+   }
+   {
+      RingBuffer<tracked, 0, 5, OverwriteOldest> rb;
+      fuzzObjects<OverwriteOldest>(rb, 5, 1, seed + 1);
+   }
+   CHECK(tracked::live == 0);       //The buffers destroyed what they still held.
+   {
+      std::vector<tracked> arr(9);
+      RingBuffer<tracked, 0, 0, DropNewest, uint8_t> rb(arr.data(), 9);
+      fuzzObjects<DropNewest>(rb, 9, 0, seed + 2);
+   }
+   CHECK(tracked::live == 0);
+}
+
+template<uint8_t Bits, size_t N>
+static void fuzzBits(uint64_t seed){
+   typedef BitRingBuffer<Bits, N> B;
+   typedef typename B::value_t V;
+   static B rb;
+   std::deque<V> ref;
+   ringRandom rng(seed);
+   size_t written = 0;
+   V mask = (V)((1u << Bits) - 1);
+   V last = 0;
+
+   rb = B();
+   for(size_t step = 0; step < steps; step++){
+      V v = sample<V>(rng);
+
+      switch(rng.below(4)){
+         case 0:
+            if(ref.size() < N){
+               ref.push_back(v & mask);
+               written++;
+            }
+            CHECK(rb.p_write(v) == written % N);
+            break;
+
+         case 1:
+            if(ref.size() == N){
+               ref.pop_front();
+            }
+            ref.push_back(v & mask);
+            written++;
+            CHECK(rb.write(v) == written % N);
+            break;
+
+         case 2:{
+            V got = rb.p_read();
+            if(ref.empty()){
+               CHECK(written == 0 || got == last);
+            }else{
+               CHECK(got == ref.front());
+               last = got;
+               ref.pop_front();
+            }
+            break;
+         }
+
+         case 3:
+            if(!ref.empty()){
+               V got = rb.read();
+               CHECK(got == ref.front());
+               last = got;
+               ref.pop_front();
+            }
+            break;
+      }
+
+      CHECK(rb.isEmpty() == ref.empty());
+      CHECK(rb.isFull() == (ref.size() == N));
+   }
+}
+
+template<typename T, size_t N, uint8_t track>
+static void fuzzWindow(uint64_t seed){
+   typedef WindowRingBuffer<T, N, track> W;
+   typedef typename std::conditional<std::is_floating_point<T>::value, long double,
+           typename std::conditional<std::is_signed<T>::value, long long, unsigned long long>::type>::type wide;
+   static W win;
+   std::deque<T> ref;
+   ringRandom rng(seed);
+
+   win.clear();
+   for(size_t step = 0; step < steps; step++){
+      if(rng.below(500) == 0){
+         win.clear();
+         ref.clear();
+      }
+
+      T v = sample<T>(rng);
+      if constexpr(std::is_floating_point<T>::value){
+         v = rng.below(50) ? (T)((double)rng.below(8000) / 8 - 500) : (T)1e8;   //Eighths, with a large outlier now and then.
+      }
+      win.write(v);
+      ref.push_back(v);
+      if(ref.size() > N){
+         ref.pop_front();
+      }
+
+      wide sum = 0;                     //Summed wider than the window does, so the reference can't overflow with it.
+      T lo = ref.front();
+      T hi = ref.front();
+      for(T x : ref){
+         sum += (wide)x;
+         lo = (x < lo) ? x : lo;
+         hi = (x > hi) ? x : hi;
+      }
+      CHECK(win.size() == ref.size());
+      CHECK(win.isFull() == (ref.size() == N));
+      CHECK((wide)win.sum() == sum);              //Exact for the float samples too, as they are all eighths.
+      if constexpr((track & RB_WINDOW_MIN) != 0){
+         CHECK(win.min() == lo);
+      }
+      if constexpr((track & RB_WINDOW_MAX) != 0){
+         CHECK(win.max() == hi);
+      }
+   }
+}
+
+/**
+ * A window of 32 bit values whose sum no longer fits 32 bits.
+ */
+static void fuzzWide(){
+   WindowRingBuffer<int32_t, 4> win;
+   for(int i = 0; i < 4; i++){
+      win.write(2000000000);
+   }
+   CHECK(win.sum() == 8000000000LL);
+   CHECK(win.mean() == 2000000000);
+   win.write(-2000000000);
+   CHECK(win.sum() == 4000000000LL);
+
+   WindowRingBuffer<uint32_t, 3> up;
+   for(int i = 0; i < 5; i++){
+      up.write(4000000000u);
+   }
+   CHECK(up.sum() == 12000000000ULL);
+
+   WindowRingBuffer<float, 4> fl;                //A large value leaving a float window takes no small ones with it.
+   fl.write(1e8f);
+   for(int i = 0; i < 8; i++){
+      fl.write(1.0f);
+   }
+   CHECK(fl.sum() == 4);
+   CHECK(fl.mean() == 1);
+}
+
+template<size_t N>
+static void fuzzMulti(uint64_t seed){
+   typedef MultiRingBuffer<int16_t, 3, N> M;
+   typedef std::vector<int16_t> frame;
+   static M rb;
+   std::deque<frame> ref;
+   ringRandom rng(seed);
+   size_t written = 0;
+
+   rb = M();
+   for(size_t step = 0; step < steps; step++){
+      frame f(3);
+      for(int16_t &x : f){
+         x = sample<int16_t>(rng);
+      }
+
+      switch(rng.below(5)){
+         case 0:
+            if(ref.size() < N){
+               ref.push_back(f);
+               written++;
+            }
+            CHECK(rb.p_write(f.data()) == written % N);
+            break;
+
+         case 1:
+            if(ref.size() == N){
+               ref.pop_front();
+            }
+            ref.push_back(f);
+            written++;
+            CHECK(rb.write(f[0], f[1], f[2]) == written % N);
+            break;
+
+         case 2:{
+            frame got(3, 7);
+            CHECK(rb.read(got.data()) == !ref.empty());
+            if(!ref.empty()){
+               CHECK(got == ref.front());
+               ref.pop_front();
+            }
+            break;
+         }
+
+         case 3:{
+            typename M::span s = rb.peek();
+            size_t toEnd = N - (written - ref.size()) % N;
+            CHECK(s.length == (ref.size() < toEnd ? ref.size() : toEnd));
+            for(size_t i = 0; i < s.length; i++){
+               for(uint8_t c = 0; c < 3; c++){
+                  CHECK(rb.channel(c)[s.index + i] == ref[i][c]);
+               }
+            }
+            size_t k = rng.below((size_t)s.length + 1);
+            rb.consume(k);
+            ref.erase(ref.begin(), ref.begin() + k);
+            break;
+         }
+
+         case 4:
+            CHECK(rb.size() == ref.size());
+            CHECK(rb.isEmpty() == ref.empty());
+            CHECK(rb.isFull() == (ref.size() == N));
+            break;
+      }
+   }
+}
+
+/**
+ * Messages must come out as they went in, and a message of up to maxMessage() bytes is never refused by an empty
+ * buffer, however the earlier messages left the indices.
+ */
+template<uint8_t contiguous, typename M>
+static void fuzzMessages(M &rb, uint64_t seed){
+   typedef std::vector<uint8_t> msg;
+   std::deque<msg> ref;
+   ringRandom rng(seed);
+   uint16_t most = rb.maxMessage();
+
+   for(size_t step = 0; step < steps; step++){
+      if(rng.below(2)){
+         size_t len = rng.below(4) ? rng.below(most / 4 + 2) : rng.below(most + 3);
+         msg m(len);
+         for(uint8_t &x : m){
+            x = sample<uint8_t>(rng);
+         }
+
+         uint8_t ok = rb.writeMessage(m.data(), (uint16_t)len);
+         if(len == 0 || len > most){
+            CHECK(!ok);
+         }else if(ref.empty()){
+            CHECK(ok);
+         }
+         if(ok){
+            ref.push_back(m);
+         }
+      }else if(contiguous && rng.below(2)){
+         if constexpr(contiguous != 0){
+            typename M::span s = rb.readMessage();
+            if(ref.empty()){
+               CHECK(s.length == 0);
+            }else{
+               CHECK(msg(s.addr, s.addr + s.length) == ref.front());
+               rb.consumeMessage();
+               ref.pop_front();
+            }
+         }
+      }else{
+         msg got(most + 1);
+         uint16_t max = (uint16_t)rng.below(most + 2);
+         uint16_t len = rb.readMessage(got.data(), max);
+         if(ref.empty()){
+            CHECK(len == 0);
+         }else{
+            msg &want = ref.front();
+            CHECK(len == want.size());
+            size_t n = (len < max) ? len : max;
+            CHECK(std::equal(want.begin(), want.begin() + n, got.begin()));
+            ref.pop_front();
+         }
+      }
+      CHECK(rb.isEmpty() == ref.empty());
+   }
+}
+
+/**
+ * maxMessage() against what an empty buffer actually takes, down to buffers too small for any message.
+ */
+template<uint8_t contiguous>
+static void fuzzMessageLimit(size_t len){
+   std::vector<uint8_t> arr(len);
+   std::vector<uint8_t> msg(len + 1, 0x5A);
+   MessageRingBuffer<0, contiguous> rb(arr.data(), len);
+   uint16_t most = rb.maxMessage();
+
+   CHECK(most < len);
+   if(most){
+      CHECK(rb.writeMessage(msg.data(), most));
+      CHECK(rb.readMessage(msg.data(), most) == most);
+   }
+   CHECK(!rb.writeMessage(msg.data(), most + 1));
+}
+
+static void fuzzMessageBuffers(uint64_t seed){
+   for(size_t len = 1; len < 8; len++){
+      fuzzMessageLimit<1>(len);
+      fuzzMessageLimit<0>(len);
+   }
+   fuzzMessageLimit<1>(260);
+   fuzzMessageLimit<0>(260);
+   CHECK(MessageRingBuffer<1>().maxMessage() == 0);
+   {
+      static MessageRingBuffer<64> rb;
+      fuzzMessages<1>(rb, seed);
+   }
+   {
+      static MessageRingBuffer<50, 0> rb;
+      fuzzMessages<0>(rb, seed + 1);
+   }
+   {
+      std::vector<uint8_t> arr(700);
+      MessageRingBuffer<0> rb(arr.data(), arr.size());
+      fuzzMessages<1>(rb, seed + 2);
+   }
+   {
+      std::vector<uint8_t> arr(300);
+      MessageRingBuffer<0, 0> rb(arr.data(), arr.size());
+      fuzzMessages<0>(rb, seed + 3);
+   }
+}
+
+static void fuzzPriority(uint64_t seed){
+   static PriorityRingSet<uint16_t, 5, 4> set;
+   std::deque<uint16_t> ref[5];
+   ringRandom rng(seed);
+
+   for(size_t step = 0; step < steps; step++){
+      if(rng.below(2)){
+         uint8_t level = (uint8_t)rng.below(6);
+         uint16_t v = sample<uint16_t>(rng);
+         uint8_t ok = level < 5 && ref[level].size() < 4;
+         CHECK(set.write(level, v) == ok);
+         if(ok){
+            ref[level].push_back(v);
+         }
+      }else{
+         int top = -1;
+         for(int l = 4; l >= 0 && top < 0; l--){
+            top = ref[l].empty() ? -1 : l;
+         }
+         CHECK(set.top() == top);
+
+         uint16_t v = 0;
+         uint8_t level = 0;
+         CHECK(set.read(v, level) == (top >= 0));
+         if(top >= 0){
+            CHECK(level == top);
+            CHECK(v == ref[top].front());
+            ref[top].pop_front();
+         }
+      }
+
+      uint8_t mask = 0;
+      for(uint8_t l = 0; l < 5; l++){
+         mask |= ref[l].empty() ? 0 : 1 << l;
+         CHECK(set.size(l) == ref[l].size());
+      }
+      CHECK(set.levels() == mask);
+      CHECK(set.isEmpty() == (mask == 0));
+   }
+}
+
+/**
+ * Encodes a random walk, with the odd jump across the whole range, and decodes it again.
+ */
+template<typename T>
+static void fuzzDelta(uint64_t seed){
+   DeltaEncoder<T> enc;
+   DeltaEncoder<T> dec;
+   ringRandom rng(seed);
+   std::vector<T> samples;
+   std::vector<uint8_t> bytes;
+   T x = 0;
+
+   for(size_t i = 0; i < steps; i++){
+      x = rng.below(50) ? (T)(x + (T)(rng.below(200) - 100)) : sample<T>(rng);
+      samples.push_back(x);
+
+      uint8_t out[DeltaEncoder<T>::maxBytes];
+      uint8_t n = enc.encode(x, out);
+      CHECK(n >= 1 && n <= DeltaEncoder<T>::maxBytes);
+      bytes.insert(bytes.end(), out, out + n);
+   }
+
+   size_t at = 0;
+   for(size_t i = 0; i < samples.size(); i++){
+      T got = 0;
+      DeltaEncoder<T> probe = dec;
+      uint8_t n = dec.decode(bytes.data() + at, bytes.size() - at, got);
+      T kept = 0;
+      size_t cut = rng.below(n + 1);
+      CHECK(probe.decode(bytes.data() + at, cut, kept) == ((cut == n) ? n : 0));   //A cut sample is left alone.
+      CHECK(cut == n ? kept == got : kept == 0);
+      CHECK(n != 0 && got == samples[i]);
+      at += n;
+   }
+   CHECK(at == bytes.size());
+}
+
+/**
+ * drain() has to encode every sample once, in order, whatever the block sizes.
+ */
+static void fuzzDrain(uint64_t seed){
+   static RingBuffer<int16_t, 1, 32, ReturnError> ring;
+   DeltaEncoder<int16_t> enc;
+   DeltaEncoder<int16_t> dec;
+   ringRandom rng(seed);
+   std::deque<int16_t> ref;
+   int16_t x = 0;
+
+   for(size_t step = 0; step < steps / 10; step++){
+      size_t n = rng.below(40);
+      for(size_t i = 0; i < n; i++){
+         x = (int16_t)(x + (int16_t)(rng.below(600) - 300));
+         if(ref.size() < 32){
+            ref.push_back(x);              //p_write() drops it once the ring is full.
+         }
+         ring.p_write(x);
+      }
+
+      uint8_t block[40];
+      size_t max = rng.below(sizeof(block) + 1);
+      size_t used = enc.drain(ring, block, max);
+      CHECK(used <= max);
+
+      size_t at = 0;
+      int16_t got;
+      while(at < used){
+         uint8_t k = dec.decode(block + at, used - at, got);
+         CHECK(k != 0 && !ref.empty() && got == ref.front());
+         if(k == 0 || ref.empty()){
+            break;
+         }
+         ref.pop_front();
+         at += k;
+      }
+      CHECK(ring.size() == ref.size());
+      CHECK(ref.empty() || max - used < DeltaEncoder<int16_t>::maxBytes);
+   }
+}
+
+/**
+ * Plays the DMA controller: fills the array circularly and keeps the remaining-transfer count it would, sometimes
+ * showing the 0 it reads as during a reload.
+ */
+template<typename R>
+static void fuzzDma(size_t len, uint64_t seed){
+   std::vector<uint16_t> arr(len);
+   volatile R remaining = (R)len;
+   DmaRingBuffer<uint16_t, R> rb(arr.data(), (uint16_t)len, &remaining);
+   std::deque<uint16_t> ref;
+   ringRandom rng(seed);
+   size_t w = 0;
+   uint16_t last = 0;
+   uint8_t hasLast = 0;
+
+   for(size_t step = 0; step < steps; step++){
+      size_t before = ref.size();
+
+      switch(rng.below(6)){
+         case 0:{
+            size_t n = rng.below(len - before);             //The reader has to keep up, as on the real part.
+            for(size_t i = 0; i < n; i++){
+               arr[w] = sample<uint16_t>(rng);
+               ref.push_back(arr[w]);
+               w = (w + 1 == len) ? 0 : w + 1;
+            }
+            remaining = (R)((w == 0 && rng.below(2)) ? 0 : len - w);
+            break;
+         }
+
+         case 1:{
+            uint16_t got = rb.read();
+            if(before == 0){
+               CHECK(!hasLast || got == last);
+            }else{
+               CHECK(got == ref.front());
+               ref.pop_front();
+               last = got;
+               hasLast = 1;
+            }
+            break;
+         }
+
+         case 2:{
+            uint16_t got = 0;
+            CHECK(rb.pop(got) == (before != 0));
+            if(before){
+               CHECK(got == ref.front());
+               ref.pop_front();
+               last = got;
+               hasLast = 1;
+            }
+            break;
+         }
+
+         case 3:{
+            std::vector<uint16_t> dst(len);
+            size_t n = rng.below(len);
+            size_t ret = rb.read(dst.data(), n);
+            CHECK(ret == (n < before ? n : before));
+            for(size_t i = 0; i < ret; i++){
+               CHECK(dst[i] == ref.front());
+               last = ref.front();
+               hasLast = 1;
+               ref.pop_front();
+            }
+            break;
+         }
+
+         case 4:{
+            typename DmaRingBuffer<uint16_t, R>::span s = rb.peek();
+            CHECK(s.length <= before && (s.length != 0 || before == 0));
+            for(size_t i = 0; i < s.length; i++){
+               CHECK(s.addr[i] == ref[i]);
+            }
+            size_t k = rng.below((size_t)s.length + 1);
+            rb.consume((uint16_t)k);
+            for(size_t i = 0; i < k; i++){
+               last = ref.front();
+               hasLast = 1;
+               ref.pop_front();
+            }
+            break;
+         }
+
+         case 5:
+            if(rng.below(20) == 0){
+               rb.flush();
+               if(before){
+                  last = ref.back();
+                  hasLast = 1;
+               }
+               ref.clear();
+            }
+            break;
+      }
+
+      CHECK(rb.writeIndex() == w);
+      CHECK(rb.size() == ref.size());
+      CHECK(rb.isEmpty() == ref.empty());
+   }
+}
+
+template<typename T, size_t N, typename F>
+static void fuzzFlash(F &rb, std::vector<T> const &table, uint64_t seed){
+   ringRandom rng(seed);
+   size_t len = table.size();
+   size_t pos = 0;
+
+   for(size_t step = 0; step < steps; step++){
+      switch(rng.below(4)){
+         case 0:
+            CHECK(rb.read() == table[pos]);
+            pos = (pos + 1) % len;
+            break;
+
+         case 1:{
+            std::vector<T> dst(3 * len);
+            size_t n = rng.below(dst.size());
+            rb.read(dst.data(), n);
+            for(size_t i = 0; i < n; i++){
+               CHECK(dst[i] == table[pos]);
+               pos = (pos + 1) % len;
+            }
+            break;
+         }
+
+         case 2:
+            CHECK(rb.peek() == table[pos]);
+            break;
+
+         case 3:
+            pos = rng.below(len);
+            rb.seek(pos);
+            break;
+      }
+      CHECK(rb.position() == pos);
+      CHECK(rb.length() == len);
+   }
+}
+
+static void fuzzFlashBuffers(uint64_t seed){
+   ringRandom rng(seed);
+   std::vector<uint16_t> a(8);
+   std::vector<uint32_t> b(6);
+   std::vector<uint8_t> c(5);
+   std::vector<int16_t> d(200);
+
+   for(uint16_t &x : a){
+      x = sample<uint16_t>(rng);
+   }
+   for(uint32_t &x : b){
+      x = sample<uint32_t>(rng);
+   }
+   for(uint8_t &x : c){
+      x = sample<uint8_t>(rng);
+   }
+   for(int16_t &x : d){
+      x = sample<int16_t>(rng);
+   }
+
+   FlashRingBuffer<uint16_t, 8> fa(a.data());
+   FlashRingBuffer<uint32_t, 6> fb(b.data());
+   FlashRingBuffer<uint8_t> fc(c.data(), 5);
+   FlashRingBuffer<int16_t, 200> fd(d.data());
+   static_assert(sizeof(fd.position()) == 1, "A table of up to 255 elements keeps a single byte index.");
+   fuzzFlash<uint16_t, 8>(fa, a, seed + 1);
+   fuzzFlash<uint32_t, 6>(fb, b, seed + 2);
+   fuzzFlash<uint8_t, 0>(fc, c, seed + 3);
+   fuzzFlash<int16_t, 200>(fd, d, seed + 4);
+}
+
+static void fuzzMPMC(uint64_t seed){
+   static MPMCRingBuffer<uint32_t, 16> rb;
+   std::deque<uint32_t> ref;
+   ringRandom rng(seed);
+
+   for(size_t step = 0; step < steps; step++){
+      if(rng.below(2)){
+         uint32_t v = sample<uint32_t>(rng);
+         CHECK(rb.write(v) == (ref.size() < 16));
+         if(ref.size() < 16){
+            ref.push_back(v);
+         }
+      }else{
+         uint32_t v = 0;
+         CHECK(rb.read(v) == !ref.empty());
+         if(!ref.empty()){
+            CHECK(v == ref.front());
+            ref.pop_front();
+         }
+      }
+      CHECK(rb.isEmpty() == ref.empty());
+      CHECK(rb.isFull() == (ref.size() == 16));
+   }
+}
+
+#if defined(__linux__)
+static void fuzzMirror(uint64_t seed){
+   MirrorRingBuffer<uint32_t> rb(1000);
+   std::deque<uint32_t> ref;
+   ringRandom rng(seed);
+
+   CHECK(rb.isValid());
+   if(!rb.isValid()){
+      return;
+   }
+
+   size_t len = rb.capacity();
+   CHECK(len >= 1000 && RB_IS_POW2(len));
+   std::vector<uint32_t> buf(len + 10);
+
+   for(size_t step = 0; step < steps; step++){
+      size_t before = ref.size();
+      size_t n = rng.below(len + 10);
+
+      switch(rng.below(4)){
+         case 0:{
+            for(size_t i = 0; i < n; i++){
+               buf[i] = sample<uint32_t>(rng);
+            }
+            size_t ret = rb.write(buf.data(), n);
+            CHECK(ret == (n < len - before ? n : len - before));
+            ref.insert(ref.end(), buf.begin(), buf.begin() + ret);
+            break;
+         }
+
+         case 1:{
+            size_t ret = rb.read(buf.data(), n);
+            CHECK(ret == (n < before ? n : before));
+            CHECK(std::equal(buf.begin(), buf.begin() + ret, ref.begin()));
+            ref.erase(ref.begin(), ref.begin() + ret);
+            break;
+         }
+
+         case 2:{
+            MirrorRingBuffer<uint32_t>::span s = rb.reserve(n);
+            CHECK(s.length == (n < len - before ? n : len - before));
+            size_t k = rng.below(s.length + 1);
+            for(size_t i = 0; i < k; i++){
+               s.addr[i] = sample<uint32_t>(rng);
+               ref.push_back(s.addr[i]);
+            }
+            rb.commit(k);
+            break;
+         }
+
+         case 3:{
+            MirrorRingBuffer<uint32_t>::span s = rb.peek();
+            CHECK(s.length == before);                      //Never split by the wrap.
+            CHECK(std::equal(s.addr, s.addr + s.length, ref.begin()));
+            size_t k = rng.below(s.length + 1);
+            rb.consume(k);
+            ref.erase(ref.begin(), ref.begin() + k);
+            break;
+         }
+      }
+      CHECK(rb.size() == ref.size());
+   }
+}
+#endif
+
+/**
+ * Collects what dump() prints, as Print would send it down a serial port.
+ */
+struct stringPrinter{
+   std::string text;
+
+   void print(unsigned long value){
+      text += std::to_string(value);
+   }
+
+   void print(char c){
+      text += c;
+   }
+
+   void println(unsigned long value){
+      print(value);
+      text += '\n';
+   }
+};
+
+/**
+ * Records bursts of events, often more than the ring holds, and dumps it now and then. The dump has to list the last N
+ * records, oldest first, with the clock each was stamped with, and leave the ring empty.
+ */
+template<size_t N>
+static void fuzzTrace(uint64_t seed){
+   TraceRingBuffer<N, uint8_t, uint16_t> trace;
+   std::deque<std::pair<uint16_t, uint8_t>> ref;
+   ringRandom rng(seed);
+
+   traceNow = 0;
+   for(size_t step = 0; step < steps / 10; step++){
+      if(rng.below(5)){
+         size_t n = rng.below(2 * N + 3);
+         for(size_t i = 0; i < n; i++){
+            uint8_t id = (uint8_t)rng.next();
+            RB_TRACE(trace, id);
+            ref.push_back(std::make_pair((uint16_t)traceNow, id));
+            if(ref.size() > N){
+               ref.pop_front();                         //The oldest record is overwritten.
+            }
+         }
+         CHECK(trace.size() == ref.size());
+         if(!ref.empty()){
+            CHECK(trace[0].time == ref.front().first && trace[0].id == ref.front().second);
+         }
+      }else{
+         stringPrinter out;
+         std::string expected;
+         for(auto const &r : ref){
+            expected += std::to_string(r.first) + ' ' + std::to_string(r.second) + '\n';
+         }
+         trace.dump(out);
+         CHECK(out.text == expected);
+         CHECK(trace.isEmpty());
+         ref.clear();
+      }
+   }
+}
+
+/**
+ * Checks a stage's counters after one run that started with backlog elements waiting and used ret of them.
+ */
+static void checkStage(ringStageStats const &before, ringStageStats const &after, size_t backlog, size_t ret){
+   CHECK(after.maxBacklog == (backlog > before.maxBacklog ? backlog : before.maxBacklog));
+   CHECK(after.moved == before.moved + ret);
+   CHECK(after.batches == before.batches + (ret != 0));
+   CHECK(after.stalls == before.stalls + (backlog != 0 && ret == 0));
+}
+
+/**
+ * A stage feeding a sink. The sink takes a random number of elements per run, often none, so the middle ring fills
+ * and stalls the stage, which in turn fills the input and refuses the producer. Everything that gets through has to
+ * come out of the sink in order.
+ */
+static void fuzzPipeline(uint64_t seed){
+   RingBuffer<uint16_t, 1, 32> in;
+   RingBuffer<uint32_t, 1, 12> mid;
+   std::vector<uint32_t> out;
+   std::vector<uint32_t> expected;
+   size_t allow = 0;
+   uint16_t produced = 0;
+   ringRandom rng(seed);
+
+   auto stage = ringStage(in, mid, [](uint16_t const *src, size_t n, uint32_t *dst, size_t room, size_t &made){
+      size_t k = (n < room) ? n : room;
+      for(size_t i = 0; i < k; i++){
+         dst[i] = 2 * (uint32_t)src[i] + 1;
+      }
+      made = k;
+      return k;
+   }, 5);
+   auto sink = ringSink(mid, [&out, &allow](uint32_t const *src, size_t n){
+      size_t k = (n < allow) ? n : allow;
+      out.insert(out.end(), src, src + k);
+      return k;
+   });
+
+   for(size_t step = 0; step < steps; step++){
+      switch(rng.below(4)){
+         case 0:{
+            uint16_t buf[40];
+            size_t n = rng.below(40);
+            size_t space = 32 - in.size();
+            for(size_t i = 0; i < n; i++){
+               buf[i] = produced + i;
+            }
+            size_t ret = in.write(buf, n);
+            CHECK(ret == (n < space ? n : space));      //A full input refuses the producer.
+            for(size_t i = 0; i < ret; i++){
+               expected.push_back(2 * (uint32_t)buf[i] + 1);
+            }
+            produced += ret;
+            break;
+         }
+
+         case 1:{
+            ringStageStats before = stage.stats();
+            size_t backlog = in.size();
+            uint8_t full = mid.isFull();
+            size_t ret = stage.run();
+            CHECK(ret <= 5);
+            CHECK(!full || ret == 0);                   //No room downstream, so the stage stalls.
+            CHECK(backlog == 0 || full || ret != 0);
+            checkStage(before, stage.stats(), backlog, ret);
+            break;
+         }
+
+         case 2:{
+            ringStageStats before = sink.stats();
+            size_t backlog = mid.size();
+            allow = rng.below(3) ? 0 : rng.below(16);
+            size_t ret = sink.run();
+            CHECK(ret <= allow);
+            checkStage(before, sink.stats(), backlog, ret);
+            break;
+         }
+
+         case 3:
+            allow = 16;
+            ringRun(stage, sink);
+            break;
+      }
+      CHECK(out.size() + mid.size() + in.size() == expected.size());
+      CHECK(std::equal(out.begin(), out.end(), expected.begin()));
+   }
+
+   CHECK(stage.stats().stalls != 0);
+   CHECK(sink.stats().stalls != 0);
+   stage.resetStats();
+   CHECK(stage.stats().batches == 0 && stage.stats().moved == 0 && stage.stats().stalls == 0);
+   CHECK(stage.stats().maxBacklog == 0);
+
+#if defined(__linux__)
+   MirrorRingBuffer<uint32_t> mirror(64);                //Any ring with reserve() and commit() can be an output.
+   auto copy = ringStage(in, mirror, [](uint16_t const *src, size_t n, uint32_t *dst, size_t room, size_t &made){
+      made = (n < room) ? n : room;
+      for(size_t i = 0; i < made; i++){
+         dst[i] = src[i];
+      }
+      return made;
+   });
+   size_t waiting = in.size();
+   while(copy.run()){
+   }
+   CHECK(in.isEmpty());
+   CHECK(mirror.size() == waiting);
+#endif
+}
+
+int main(){
+   fuzzPolicy<OverwriteOldest>(100);
+   fuzzPolicy<DropNewest>(200);
+   fuzzPolicy<ReturnError>(300);
+   fuzzPolicy<Block>(400);
+   fuzzLifetimes(500);
+   fuzzLength<uint16_t>(200, 200);
+   fuzzLength<uint32_t>(255, 255);
+   fuzzLength<uint8_t>(200, 127);
+
+   fuzzBits<1, 64>(600);
+   fuzzBits<3, 13>(601);
+   fuzzBits<4, 20>(602);
+   fuzzBits<12, 9>(603);
+   fuzzBits<16, 32>(604);
+
+   fuzzWindow<int16_t, 7, RB_WINDOW_MINMAX>(700);
+   fuzzWindow<uint8_t, 16, RB_WINDOW_MIN>(701);
+   fuzzWindow<int32_t, 5, RB_WINDOW_MAX>(702);
+   fuzzWindow<uint16_t, 1, RB_WINDOW_SUM>(703);
+   fuzzWindow<uint32_t, 9, RB_WINDOW_SUM>(704);
+   fuzzWindow<float, 16, RB_WINDOW_MINMAX>(705);
+   fuzzWide();
+
+   fuzzMulti<10>(800);
+   fuzzMulti<16>(801);
+   fuzzMessageBuffers(900);
+   fuzzPriority(1000);
+
+   fuzzDelta<int16_t>(1100);
+   fuzzDelta<uint32_t>(1101);
+   fuzzDelta<int64_t>(1102);
+   fuzzDelta<int8_t>(1103);
+   fuzzDrain(1104);
+
+   fuzzDma<uint32_t>(17, 1200);
+   fuzzDma<uint16_t>(64, 1201);
+   fuzzFlashBuffers(1300);
+   fuzzMPMC(1400);
+#if defined(__linux__)
+   fuzzMirror(1500);
+#endif
+   fuzzPipeline(1600);
+   fuzzTrace<8>(1700);
+   fuzzTrace<13>(1701);
+
+#if defined(RB_WATERMARKS)
+   return ringResult("fuzz (RB_WATERMARKS, RB_STATS, RB_SNAPSHOT)");
+#else
+   return ringResult("fuzz");
+#endif
+}
@@ -0,0 +1,40 @@
+/**
+ * Every header on its own terms: built as gnu++11, the dialect Arduino cores compile libraries with, so the tests being
+ * written in C++17 can't hide a newer construct in the headers.
+ */
+#include "RingBuffer.h"
+#include "BitRingBuffer.h"
+#include "DeltaEncoder.h"
+#include "DmaRingBuffer.h"
+#include "FlashRingBuffer.h"
+#include "MessageRingBuffer.h"
+#include "MPMCRingBuffer.h"
+#include "MultiRingBuffer.h"
+#include "PriorityRingSet.h"
+#include "RingPipeline.h"
+#define RB_RTOS_POSIX
+#include "RtosRingBuffer.h"
+#define RB_TRACE_UNLOCKED                //Records come from a single thread.
+#include "TraceRingBuffer.h"
+#include "WindowRingBuffer.h"
+#if defined(__linux__)
+   #include "MirrorRingBuffer.h"
+#endif
+
+/**
+ * Capacities past 32768 with an index as wide as size_t, where twice the index range no longer fits in a size_t, as
+ * with uint32_t indices on the 32 bit ESP32 and Cortex-M parts.
+ */
+static_assert(sizeof(RingBuffer<int16_t, 1, 40000, OverwriteOldest, size_t>) != 0, "Wide capacities have to build.");
+
+int main(){
+   RingBuffer<uint8_t, 1, 16> a;
+   RingBuffer<uint32_t, 0, 10, ReturnError> b;
+   TraceRingBuffer<8> trace;
+   uint32_t v = 1;
+
+   a.p_write(1);
+   b.p_write(&v);
+   trace.record(1);
+   return (a.p_read() + *b.p_read() + trace.size() == 3) ? 0 : 1;
+}
@@ -0,0 +1,50 @@
+/**
+ * Builds examples/Benchmark for the host, with just enough of the Arduino core for it to print its table to stdout.
+ * Each figure is time stamp counter ticks per element, which tracks core cycles on current x86 parts. Build it once per
+ * profile (the benchmark, benchmark_speed and benchmark_size targets) and compare the tables on the same machine.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+struct hostSerial{
+   void begin(unsigned long){
+   }
+
+   operator bool() const{
+      return true;
+   }
+
+   void print(char c){
+      putchar(c);
+   }
+
+   void print(char const *text){
+      fputs(text, stdout);
+   }
+
+   void println(char const *text){
+      puts(text);
+   }
+
+   void println(){
+      putchar('\n');
+   }
+};
+
+static hostSerial Serial;
+
+#define F(text)      (text)
+
+inline void noInterrupts(){
+}
+
+inline void interrupts(){
+}
+
+#include "../../examples/Benchmark/Benchmark.ino"
+
+int main(){
+   setup();
+   return 0;
+}
@@ -0,0 +1,532 @@
+/**
+ * Runs a producer and a consumer thread against each other on every path documented as single producer, single
+ * consumer safe, the way an ISR and loop() share a buffer. The producer writes a numbered sequence and the consumer
+ * checks it comes out whole and in order. Build with -fsanitize=thread (RB_SANITIZE=thread in CMakeLists.txt) to also
+ * have ThreadSanitizer check every handover.
+ *
+ *    stress                  Moves a million values through each buffer.
+ *    stress 50000            Moves that many instead, such as under ThreadSanitizer.
+ */
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "RingBuffer.h"
+#include "MultiRingBuffer.h"
+#include "MessageRingBuffer.h"
+#include "PriorityRingSet.h"
+#include "MPMCRingBuffer.h"
+#define RB_RTOS_POSIX                  //POSIX semaphores in place of the kernel's, ticks in milliseconds.
+#include "RtosRingBuffer.h"
+#if defined(__linux__)
+   #include "MirrorRingBuffer.h"
+#endif
+
+#include "check.h"
+
+static size_t count = 1000000;         //Values moved per buffer.
+
+/**
+ * Runs produce and consume on two threads and waits for both.
+ */
+template<typename A, typename B>
+static void both(A produce, B consume){
+   std::thread p(produce);
+   std::thread c(consume);
+   p.join();
+   c.join();
+}
+
+/**
+ * p_write() against p_read(), as from an ISR into loop(). The pointer p_read() returns refers to a slot the producer
+ * may fill again, so with the pointer specialization the producer leaves one slot free: the element then stays put
+ * until the next p_read().
+ */
+template<uint8_t value, typename T, size_t N>
+static void stressSingle(){
+   static RingBuffer<T, value, N> rb;
+   size_t bad = 0;
+
+   both([&]{
+      for(size_t i = 0; i < count; i++){
+         T v = (T)i;
+         while(value ? rb.isFull() : rb.size() >= N - 1){
+            std::this_thread::yield();
+         }
+         if constexpr(value){
+            rb.p_write(v);
+         }else{
+            rb.p_write(&v);
+         }
+      }
+   }, [&]{
+      for(size_t i = 0; i < count; i++){
+         while(rb.isEmpty()){
+            std::this_thread::yield();
+         }
+         T v;
+         if constexpr(value){
+            v = rb.p_read();
+         }else{
+            v = *rb.p_read();
+         }
+         bad += v != (T)i;
+      }
+   });
+   CHECK(bad == 0);
+   CHECK(rb.isEmpty());
+}
+
+/**
+ * emplace() under a policy that never overwrites, against pop(). Block waits inside emplace() itself.
+ */
+template<typename P, size_t N>
+static void stressEmplace(){
+   static RingBuffer<uint32_t, 0, N, P> rb;
+   size_t bad = 0;
+
+   both([&]{
+      for(size_t i = 0; i < count; i++){
+         while(rb.emplace((uint32_t)i) == rb.writeError){
+            std::this_thread::yield();
+         }
+      }
+   }, [&]{
+      for(size_t i = 0; i < count; i++){
+         uint32_t v;
+         while(!rb.pop(v)){
+            std::this_thread::yield();
+         }
+         bad += v != (uint32_t)i;
+      }
+   });
+   CHECK(bad == 0);
+}
+
+/**
+ * Bulk write(src, n) against bulk read(dst, n), with blocks of random length that wrap the array at every offset.
+ */
+static void stressBulk(){
+   std::vector<uint32_t> arr(1000);
+   RingBuffer<uint32_t, 0, 0, ReturnError, uint16_t> rb(arr.data(), 1000);
+   size_t bad = 0;
+
+   both([&]{
+      ringRandom rng(1);
+      uint32_t src[300];
+      size_t i = 0;
+      while(i < count){
+         size_t n = 1 + rng.below(300);
+         n = (n > count - i) ? count - i : n;
+         for(size_t k = 0; k < n; k++){
+            src[k] = (uint32_t)(i + k);
+         }
+         size_t done = 0;
+         while(done < n){
+            size_t stored = rb.write(src + done, n - done);
+            done += stored;
+            if(!stored){
+               std::this_thread::yield();
+            }
+         }
+         i += n;
+      }
+   }, [&]{
+      ringRandom rng(2);
+      uint32_t dst[300];
+      size_t i = 0;
+      while(i < count){
+         size_t got = rb.read(dst, 1 + rng.below(300));
+         for(size_t k = 0; k < got; k++){
+            bad += dst[k] != (uint32_t)(i + k);
+         }
+         i += got;
+         if(!got){
+            std::this_thread::yield();
+         }
+      }
+   });
+   CHECK(bad == 0);
+}
+
+/**
+ * reserve() and commit() against peek() and consume(), filling and reading the elements in place.
+ */
+static void stressSpans(){
+   static RingBuffer<uint32_t, 0, 100> rb;
+   size_t bad = 0;
+
+   both([&]{
+      ringRandom rng(3);
+      size_t i = 0;
+      while(i < count){
+         RingBuffer<uint32_t, 0, 100>::span s = rb.reserve((uint8_t)(1 + rng.below(40)));
+         size_t n = (s.length > count - i) ? count - i : s.length;
+         for(size_t k = 0; k < n; k++){
+            s.addr[k] = (uint32_t)(i + k);
+         }
+         rb.commit((uint8_t)n);
+         i += n;
+         if(!n){
+            std::this_thread::yield();
+         }
+      }
+   }, [&]{
+      ringRandom rng(4);
+      size_t i = 0;
+      while(i < count){
+         RingBuffer<uint32_t, 0, 100>::span s = rb.peek();
+         size_t n = rng.below((size_t)s.length + 1);
+         for(size_t k = 0; k < n; k++){
+            bad += s.addr[k] != (uint32_t)(i + k);
+         }
+         rb.consume((uint8_t)n);
+         i += n;
+         if(!n){
+            std::this_thread::yield();
+         }
+      }
+   });
+   CHECK(bad == 0);
+}
+
+static void stressMulti(){
+   static MultiRingBuffer<uint16_t, 3, 12> rb;
+   size_t bad = 0;
+
+   both([&]{
+      for(size_t i = 0; i < count; i++){
+         while(rb.isFull()){
+            std::this_thread::yield();
+         }
+         rb.p_write((uint16_t)i, (uint16_t)(i * 3), (uint16_t)~i);
+      }
+   }, [&]{
+      for(size_t i = 0; i < count; i++){
+         uint16_t frame[3];
+         while(!rb.read(frame)){
+            std::this_thread::yield();
+         }
+         bad += frame[0] != (uint16_t)i || frame[1] != (uint16_t)(i * 3) || frame[2] != (uint16_t)~i;
+      }
+   });
+   CHECK(bad == 0);
+}
+
+/**
+ * Messages of varying length, each filled with its own number, through both framings.
+ */
+template<uint8_t contiguous>
+static void stressMessages(){
+   static MessageRingBuffer<128, contiguous> rb;
+   size_t messages = count / 16;
+   size_t bad = 0;
+
+   both([&]{
+      uint8_t data[64];
+      for(size_t i = 0; i < messages; i++){
+         uint16_t len = 1 + i % (rb.maxMessage() < 60 ? rb.maxMessage() : 60);
+         memset(data, (uint8_t)i, len);
+         while(!rb.writeMessage(data, len)){
+            std::this_thread::yield();
+         }
+      }
+   }, [&]{
+      uint8_t data[128];
+      for(size_t i = 0; i < messages; i++){
+         uint16_t len;
+         while((len = rb.readMessage(data, sizeof(data))) == 0){
+            std::this_thread::yield();
+         }
+         bad += len != 1 + i % (rb.maxMessage() < 60 ? rb.maxMessage() : 60);
+         for(uint16_t k = 0; k < len; k++){
+            bad += data[k] != (uint8_t)i;
+         }
+      }
+   });
+   CHECK(bad == 0);
+}
+
+/**
+ * Values spread over the levels: each level keeps its own order, and nothing is lost or read twice.
+ */
+static void stressPriority(){
+   static PriorityRingSet<uint32_t, 4, 8> set;
+   size_t bad = 0;
+
+   both([&]{
+      for(size_t i = 0; i < count; i++){
+         while(!set.write((uint8_t)(i & 3), (uint32_t)i)){
+            std::this_thread::yield();
+         }
+      }
+   }, [&]{
+      uint32_t next[4] = {0, 1, 2, 3};
+      for(size_t i = 0; i < count; i++){
+         uint32_t v;
+         uint8_t level;
+         while(!set.read(v, level)){
+            std::this_thread::yield();
+         }
+         bad += v != next[level];
+         next[level] += 4;
+      }
+   });
+   CHECK(bad == 0);
+   CHECK(set.isEmpty());
+}
+
+/**
+ * Two producers and two consumers. Every value has to arrive exactly once, and each producer's values in order.
+ */
+static void stressMPMC(){
+   static MPMCRingBuffer<uint32_t, 64> rb;
+   std::vector<uint8_t> seen(count);
+   size_t bad = 0;
+   size_t got[2] = {0, 0};
+
+   auto produce = [&](uint32_t from){
+      for(uint32_t i = from; i < count; i += 2){
+         while(!rb.write(i)){
+            std::this_thread::yield();
+         }
+      }
+   };
+   auto consume = [&](int id, size_t &badHere){
+      uint32_t last[2] = {0, 1};
+      uint8_t any[2] = {0, 0};
+      while(__atomic_load_n(&got[0], __ATOMIC_RELAXED) + __atomic_load_n(&got[1], __ATOMIC_RELAXED) < count){
+         uint32_t v;
+         if(!rb.read(v)){
+            std::this_thread::yield();
+            continue;
+         }
+         badHere += v >= count || seen[v]++ || (any[v & 1] && v <= last[v & 1]);
+         last[v & 1] = v;
+         any[v & 1] = 1;
+         __atomic_fetch_add(&got[id], 1, __ATOMIC_RELAXED);
+      }
+   };
+
+   size_t bad0 = 0;
+   size_t bad1 = 0;
+   std::thread p0(produce, 0);
+   std::thread p1(produce, 1);
+   std::thread c0(consume, 0, std::ref(bad0));
+   std::thread c1(consume, 1, std::ref(bad1));
+   p0.join();
+   p1.join();
+   c0.join();
+   c1.join();
+
+   bad = bad0 + bad1;
+   CHECK(bad == 0);
+   CHECK(got[0] + got[1] == count);
+   CHECK(rb.isEmpty());
+}
+
+#if defined(__linux__)
+static void stressMirror(){
+   MirrorRingBuffer<uint32_t> rb(4096);
+   size_t bad = 0;
+
+   CHECK(rb.isValid());
+   both([&]{
+      ringRandom rng(5);
+      std::vector<uint32_t> src(3000);
+      size_t i = 0;
+      while(i < count){
+         MirrorRingBuffer<uint32_t>::span s = rb.reserve(1 + rng.below(3000));
+         size_t n = (s.length > count - i) ? count - i : s.length;
+         for(size_t k = 0; k < n; k++){
+            s.addr[k] = (uint32_t)(i + k);
+         }
+         rb.commit(n);
+         i += n;
+         if(!n){
+            std::this_thread::yield();
+         }
+      }
+   }, [&]{
+      ringRandom rng(6);
+      std::vector<uint32_t> dst(3000);
+      size_t i = 0;
+      while(i < count){
+         size_t got = rb.read(dst.data(), 1 + rng.below(3000));
+         for(size_t k = 0; k < got; k++){
+            bad += dst[k] != (uint32_t)(i + k);
+         }
+         i += got;
+         if(!got){
+            std::this_thread::yield();
+         }
+      }
+   });
+   CHECK(bad == 0);
+}
+#endif
+
+#if defined(RB_SNAPSHOT) && !defined(RB_TSAN)
+/**
+ * The writer overwrites a counter as fast as it can while the snapshots are taken: every snapshot has to be a run of
+ * consecutive values. Left out under ThreadSanitizer, as snapshotLatest() copies slots the writer may be replacing and
+ * only then finds out whether to retry, which is a race by design.
+ */
+static void stressSnapshot(){
+   static RingBuffer<uint32_t, 0, 64> rb;
+   volatile uint8_t done = 0;
+   size_t bad = 0;
+   size_t taken = 0;
+
+   both([&]{
+      for(size_t i = 1; i <= count; i++){
+         uint32_t v = (uint32_t)i;
+         rb.write(&v);
+      }
+      done = 1;
+   }, [&]{
+      uint32_t dst[40];
+      while(!done){
+         size_t k = rb.snapshotLatest(dst, 40);
+         for(size_t i = 1; i < k; i++){
+            bad += dst[i] != dst[i - 1] + 1;
+         }
+         taken += k != 0;
+      }
+   });
+   CHECK(bad == 0);
+   printf("  %zu snapshots taken\n", taken);
+}
+#endif
+
+/**
+ * Moves a numbered sequence through an RtosRingBuffer, with the producer and consumer taking turns at being the slow
+ * side so both sleep on the semaphores: the reader on an empty buffer, the writer on a full one. fromISR swaps the
+ * fast side's calls for the FromISR() variants, spinning while they find the buffer full or empty.
+ */
+static void stressRtosPass(RtosRingBuffer<uint32_t, 8> &rb, size_t n, uint8_t fromISR){
+   size_t bad = 0;
+
+   both([&]{
+      for(size_t i = 0; i < n; i++){
+         if((i / 512) % 2 == 0 && i % 64 == 0){
+            std::this_thread::sleep_for(std::chrono::microseconds(50));   //The reader catches up and sleeps.
+         }
+         if(fromISR && (i / 512) % 2 == 1){
+            while(!rb.writeFromISR((uint32_t)i)){
+               std::this_thread::yield();
+            }
+         }else{
+            CHECK(rb.writeWait((uint32_t)i));
+         }
+      }
+   }, [&]{
+      for(size_t i = 0; i < n; i++){
+         if((i / 512) % 2 == 1 && i % 64 == 0){
+            std::this_thread::sleep_for(std::chrono::microseconds(50));   //The writer fills the buffer and sleeps.
+         }
+         uint32_t v = 0;
+         if(fromISR && (i / 512) % 2 == 0){
+            while(!rb.readFromISR(v)){
+               std::this_thread::yield();
+            }
+         }else{
+            CHECK(rb.readWait(v));
+         }
+         bad += v != (uint32_t)i;
+      }
+   });
+   CHECK(bad == 0);
+   CHECK(rb.isEmpty());
+}
+
+/**
+ * How many milliseconds f takes.
+ */
+template<typename F>
+static long long timed(F f){
+   auto start = std::chrono::steady_clock::now();
+   f();
+   return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * readWait() and writeWait() against each other, then their timeouts. The timeouts run after the transfers, so a
+ * semaphore may still hold a token given to a side that found data before it slept: a wait that wakes on it has to go
+ * back to sleep for the rest of its time.
+ */
+static void stressRtos(){
+   static RtosRingBuffer<uint32_t, 8> rb;
+   size_t n = count / 10;
+   uint32_t v = 7;
+
+   rb.begin();
+   stressRtosPass(rb, n, 0);
+   stressRtosPass(rb, n, 1);
+
+   CHECK(!rb.readWait(v, 0));                           //Nothing there and no time to wait.
+   long long took = timed([&]{
+      CHECK(!rb.readWait(v, 30));
+   });
+   CHECK(took >= 29);
+   CHECK(v == 7);                                       //Left untouched by a read that timed out.
+
+   for(uint32_t i = 0; i < 8; i++){
+      CHECK(rb.write(i));
+   }
+   CHECK(!rb.write(8));
+   CHECK(!rb.writeWait(8, 0));
+   took = timed([&]{
+      CHECK(!rb.writeWait(8, 30));
+   });
+   CHECK(took >= 29);
+
+   both([&]{                                            //A timed write that room is made for in time.
+      CHECK(rb.writeWait(8, 2000));
+   }, [&]{
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      CHECK(rb.read(v) && v == 0);
+   });
+   for(uint32_t i = 1; i <= 8; i++){
+      CHECK(rb.read(v) && v == i);
+   }
+
+   both([&]{                                            //A timed read that a value arrives for in time.
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      CHECK(rb.write(42));
+   }, [&]{
+      uint32_t got = 0;
+      CHECK(rb.readWait(got, 2000) && got == 42);
+   });
+   CHECK(rb.isEmpty());
+}
+
+int main(int argc, char **argv){
+   if(argc > 1){
+      count = strtoul(argv[1], 0, 10);
+   }
+
+   stressSingle<1, uint8_t, 16>();
+   stressSingle<1, uint16_t, 100>();
+   stressSingle<0, uint64_t, 32>();
+   stressSingle<0, uint32_t, 7>();
+   stressEmplace<ReturnError, 64>();
+   stressEmplace<Block, 20>();
+   stressBulk();
+   stressSpans();
+   stressMulti();
+   stressMessages<1>();
+   stressMessages<0>();
+   stressPriority();
+   stressMPMC();
+   stressRtos();
+#if defined(__linux__)
+   stressMirror();
+#endif
+#if defined(RB_SNAPSHOT) && !defined(RB_TSAN)
+   stressSnapshot();
+#endif
+
+   return ringResult("stress");
+}
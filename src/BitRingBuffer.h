@@ -0,0 +1,179 @@
+#ifndef BIT_RING_BUFFER_H
+#define BIT_RING_BUFFER_H
+
+#include "RingBuffer.h"
+
+/**
+ * A RingBuffer for samples narrower than a byte or between byte sizes, such as 1 bit logic captures or 4 and 12 bit
+ * ADC readings. Holds N samples of Bits bits each, packed back to back, so 1 bit samples take an eighth of the memory
+ * of a RingBuffer<uint8_t>. Values are taken and returned in the smallest unsigned type that fits Bits, and only the
+ * low Bits bits are kept.
+ *
+ * Uses the same write(), read(), p_write() and p_read() as RingBuffer, with the same mirrored indices, so a single
+ * producer and consumer can share p_write() and p_read() without a critical section. Writing a sample rewrites the
+ * byte it shares with its neighbours, but puts their bits back unchanged, so the reader never sees them change.
+ *
+ * When Bits divides 8 (1, 2, 4 or 8), a sample never straddles a byte and is found with a shift and mask. Other
+ * widths read the two or three bytes a sample spans as one word.
+ */
+template<uint8_t Bits, size_t N, typename I = typename ringIndex<N>::type>
+class BitRingBuffer{
+   static_assert(Bits >= 1 && Bits <= 16, "BitRingBuffer holds samples of 1 to 16 bits.");
+   static_assert(N != 0, "BitRingBuffer needs a compile-time capacity.");
+   typedef ringWrap<N, I> wrap;
+
+   public:
+      typedef typename ringSelect<(Bits <= 8), uint8_t, uint16_t>::type value_t;
+
+      /**
+       * Construct a new, empty Bit Ring Buffer object. The packed array is stored inside the object.
+       */
+      BitRingBuffer(){
+         pos.readPos = 0;
+         pos.writePos = 0;
+      };
+
+      /**
+       * Writes a new value to the RingBuffer. When the buffer is full, overrides the oldest value, moving the read
+       * index past it. Returns the next write index.
+       *
+       * As it can move the read index, it is not safe to call while a consumer reads from another context; use
+       * p_write() for that.
+       */
+      inline I write(value_t data){
+         I w = pos.writePos;
+         I r = ringLoad(pos.readPos);
+
+         if(__builtin_expect(wrap::full(w, r), 0)){
+            ringStore(pos.readPos, wrap::next(r));    //Drops the oldest value to make room.
+         }
+
+         put(wrap::slot(w), data);
+         w = wrap::next(w);
+         ringStore(pos.writePos, w);
+         return wrap::slot(w);
+      }
+
+      /**
+       * Writes a new value to the RingBuffer, with protection. When the buffer is full, drops the new value and
+       * returns the current write index instead of the next.
+       *
+       * Safe to call from a single producer while a single consumer calls p_read(), such as from an ISR.
+       */
+      I p_write(value_t data){
+         I w = pos.writePos;
+
+         if(__builtin_expect(wrap::full(w, ringLoad(pos.readPos)), 0)){
+            return wrap::slot(w);
+         }
+
+         put(wrap::slot(w), data);
+         w = wrap::next(w);
+         RB_BARRIER();                          //The sample has to land before the consumer can see the new index.
+         ringStore(pos.writePos, w);
+
+         return wrap::slot(w);
+      }
+
+      /**
+       * Read the next value from the ring buffer. If the buffer is empty, it will return the value at the read index
+       * again without moving past it.
+       */
+      inline value_t read(){
+         I r = pos.readPos;
+         value_t item = get(wrap::slot(r));
+
+         if(__builtin_expect(r != pos.writePos, 1)){
+            ringStore(pos.readPos, wrap::next(r));
+         }
+         return item;
+      }
+
+      /**
+       * Read the next value from the ring buffer, with protection. When the buffer is empty, returns the previous
+       * value returned.
+       *
+       * Safe to call from a single consumer while a single producer calls p_write().
+       */
+      value_t p_read(){
+         I r = pos.readPos;
+         I index = wrap::slot(r);
+
+         if(__builtin_expect(r == ringLoad(pos.writePos), 0)){
+            return get((index == 0 ? N : index) - 1);
+         }
+
+         RB_BARRIER();                          //Read the sample only after seeing the producer's index.
+         value_t item = get(index);
+         RB_BARRIER();                          //The sample has to be read before the slot is handed back.
+         ringStore(pos.readPos, wrap::next(r));
+
+         return item;
+      }
+
+      /**
+       * A method that can be called to check if the ring buffer is full.
+       */
+      inline uint8_t isFull() const{
+         return wrap::full(ringLoad(pos.writePos), ringLoad(pos.readPos));
+      }
+
+      /**
+       * A method that can be called to check if the ring buffer is empty.
+       */
+      inline uint8_t isEmpty() const{
+         return ringLoad(pos.writePos) == ringLoad(pos.readPos);
+      }
+
+   private:
+      enum{
+         perByte = (8 % Bits == 0) ? 8 / Bits : 0,    //Samples per byte when none straddle a byte, 0 otherwise.
+         bytes = (N * Bits + 7) / 8 + (perByte != 0 ? 0 : 2)   //Two spare bytes, so a word read never runs off the end.
+      };
+
+      /**
+       * Stores the low Bits bits of data in sample i.
+       */
+      inline void put(I i, value_t data){
+         if(perByte != 0){
+            uint8_t shift = (i % perByte) * Bits;    //perByte is a power of two, so these are a mask and shift.
+            uint8_t mask = (uint8_t)(((1U << Bits) - 1) << shift);
+            uint8_t *p = &addr[i / perByte];
+
+            *p = (*p & ~mask) | ((data << shift) & mask);
+            return;
+         }
+
+         uint32_t bit = (uint32_t)i * Bits;
+         uint8_t *p = &addr[bit >> 3];
+         uint8_t shift = bit & 7;
+         uint32_t mask = ((1UL << Bits) - 1) << shift;
+         uint32_t word = p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+
+         word = (word & ~mask) | (((uint32_t)data << shift) & mask);
+         p[0] = word;
+         p[1] = word >> 8;
+         p[2] = word >> 16;
+      }
+
+      /**
+       * Returns sample i.
+       */
+      inline value_t get(I i) const{
+         if(perByte != 0){
+            uint8_t shift = (i % perByte) * Bits;
+            return (addr[i / perByte] >> shift) & ((1U << Bits) - 1);
+         }
+
+         uint32_t bit = (uint32_t)i * Bits;
+         uint8_t const *p = &addr[bit >> 3];
+         uint32_t word = p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+
+         return (word >> (bit & 7)) & ((1UL << Bits) - 1);
+      }
+
+      ringIndices<I> pos;              //The read and write indices.
+      uint8_t addr[bytes];             //The packed samples.
+};
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef DELTA_ENCODER_H
+#define DELTA_ENCODER_H
+
+#include "RingBuffer.h"
+
+/**
+ * The unsigned type of the same size as T, which the encoder does its arithmetic in so differences wrap instead of
+ * overflowing.
+ */
+template<size_t size>
+struct ringUnsigned{
+   typedef uint8_t type;
+};
+
+template<>
+struct ringUnsigned<2>{
+   typedef uint16_t type;
+};
+
+template<>
+struct ringUnsigned<4>{
+   typedef uint32_t type;
+};
+
+template<>
+struct ringUnsigned<8>{
+   typedef uint64_t type;
+};
+
+/**
+ * Compresses a series of integer samples, such as sensor readings on their way from a RingBuffer to an SD card. Each
+ * sample is stored as its difference from the one before (delta), folded so small negative differences become small
+ * numbers too (zigzag), in as few 7 bit groups as it needs (varint). A slowly changing int16_t reading then takes one
+ * byte instead of two, and a uint32_t counter or timestamp one or two instead of four.
+ *
+ *    DeltaEncoder<int16_t> enc;
+ *    uint8_t block[512];
+ *    enc.reset();                           //Every block decodes on its own.
+ *    size_t used = enc.drain(samples, block, sizeof(block));
+ *    file.write(block, used);
+ *
+ * drain() encodes straight out of the ring's peek() blocks and consumes what it encoded, so no second copy of the
+ * samples is needed. encode() takes one sample at a time instead, such as to compress on entry into a byte ring.
+ * decode() reverses either, given the same starting point: a DeltaEncoder that was reset() at the same place.
+ */
+template<typename T>
+class DeltaEncoder{
+   static_assert((T)1 / 2 == 0, "DeltaEncoder only takes integer samples.");
+   typedef typename ringUnsigned<sizeof(T)>::type U;
+
+   public:
+      /**
+       * The most bytes a single sample can take once encoded.
+       */
+      static const uint8_t maxBytes = (sizeof(T) * 8 + 6) / 7;
+
+      /**
+       * Construct a new Delta Encoder object, starting from a previous sample of 0.
+       */
+      DeltaEncoder(){
+         last = 0;
+      };
+
+      /**
+       * Starts over from a previous sample of 0, such as at the start of every block written out, so each block can
+       * be decoded without the ones before it.
+       */
+      inline void reset(){
+         last = 0;
+      }
+
+      /**
+       * Encodes value into out, which needs room for maxBytes. Returns the number of bytes used.
+       */
+      uint8_t encode(T value, uint8_t *out){
+         U d = (U)((U)value - (U)last);
+         U z = (U)((U)(d << 1) ^ (U)(0 - (U)(d >> (sizeof(T) * 8 - 1))));
+         uint8_t n = 0;
+
+         last = value;
+         while(z >= 0x80){
+            out[n++] = (uint8_t)z | 0x80;
+            z >>= 7;
+         }
+         out[n++] = (uint8_t)z;
+
+         return n;
+      }
+
+      /**
+       * Decodes the next sample out of len bytes at in into value. Returns the number of bytes it took, or 0, leaving
+       * value untouched, when len ends part way through a sample.
+       */
+      uint8_t decode(uint8_t const *in, size_t len, T &value){
+         U z = 0;
+         uint8_t n = 0;
+
+         do{
+            if(n == len || n == maxBytes){
+               return 0;
+            }
+            z |= (U)(in[n] & 0x7F) << (7 * n);
+         }while(in[n++] & 0x80);
+
+         last = (T)((U)last + (U)((z >> 1) ^ (U)(0 - (z & 1))));
+         value = last;
+         return n;
+      }
+
+      /**
+       * Encodes samples out of ring into out, at most max bytes, and removes the samples it encoded. Stops when the
+       * ring is empty or out has less than maxBytes left, so every sample is either encoded whole or left in the ring.
+       * Returns the number of bytes written to out. Follows the same single consumer rules as peek() and consume().
+       */
+      template<typename R>
+      size_t drain(R &ring, uint8_t *out, size_t max){
+         size_t used = 0;
+
+         for(;;){
+            typename R::span s = ring.peek();
+            size_t i = 0;
+
+            while(i < s.length && max - used >= maxBytes){
+               used += encode(s.addr[i++], out + used);
+            }
+            ring.consume(i);
+
+            if(i == 0 || i < s.length){
+               return used;
+            }
+         }
+      }
+
+   private:
+      T last;                          //The sample the next difference is taken from.
+};
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef DMA_RING_BUFFER_H
+#define DMA_RING_BUFFER_H
+
+#include "RingBuffer.h"
+
+/**
+ * The reading side of a ring buffer filled by a DMA channel in circular mode, such as UART or ADC reception on STM32
+ * (NDTR) or SAMD (BTCNT). The DMA controller is the producer: there is no write index to store, and no interrupt per
+ * element. Whenever the reader needs it, the write index is worked out from the channel's remaining-transfer count,
+ * which counts down from the length of the array and reloads when the transfer wraps.
+ *
+ *    DmaRingBuffer<uint8_t> rx(dmaBuf, sizeof(dmaBuf), &DMA1_Stream5->NDTR);
+ *    HAL_UART_Receive_DMA(&huart1, dmaBuf, sizeof(dmaBuf));
+ *    while(rx.pop(c)){ ... }
+ *
+ * The DMA controller never waits for the reader, so the reader has to keep less than a full lap of the array unread:
+ * a lap looks the same as an empty buffer, and falling behind can't be detected afterwards. On parts with a data cache
+ * (Cortex-M7), the array has to sit in memory the cache leaves alone, or the lines have to be invalidated before
+ * reading.
+ *
+ * R is the type of the count register, volatile uint32_t on STM32 and uint16_t for a SAMD writeback descriptor.
+ */
+template<typename T, typename R = uint32_t>
+class DmaRingBuffer{
+   static_assert(__is_trivially_copyable(T), "DmaRingBuffer elements are written by the DMA controller as raw bytes.");
+
+   public:
+      /**
+       * A contiguous block of elements inside the DMA array.
+       */
+      struct span{
+         T *addr;                               //The first element of the block.
+         uint16_t length;                       //How many elements are in the block.
+      };
+
+      /**
+       * Construct a new DMA Ring Buffer object over the array the channel writes to, of the given number of
+       * elements, and the channel's remaining-transfer count register. Start the channel before the first read.
+       */
+      DmaRingBuffer(T *arr, uint16_t elements, R const volatile *remaining){
+         addr = arr;
+         arrLen = elements;
+         counter = remaining;
+         readPos = 0;
+      };
+
+      /**
+       * Returns the index the DMA controller writes to next. The count reads as 0 for a moment as the transfer
+       * reloads, which is the same position as a full count.
+       */
+      inline uint16_t writeIndex() const{
+         uint16_t left = *counter;
+
+         return (left == 0 || left >= arrLen) ? 0 : arrLen - left;
+      }
+
+      /**
+       * Returns the number of elements the DMA controller has written that have not been read yet.
+       */
+      inline uint16_t size() const{
+         uint16_t w = writeIndex();
+
+         return (w >= readPos) ? w - readPos : w + arrLen - readPos;
+      }
+
+      /**
+       * Checks if every element written so far has been read.
+       */
+      inline uint8_t isEmpty() const{
+         return writeIndex() == readPos;
+      }
+
+      /**
+       * Read the next value. When the buffer is empty, returns the previous value read without moving, the same as
+       * RingBuffer::p_read().
+       */
+      T read(){
+         uint16_t r = readPos;
+
+         if(__builtin_expect(r == writeIndex(), 0)){
+            return addr[(r == 0 ? arrLen : r) - 1];
+         }
+
+         RB_BARRIER();                          //Read the element only after seeing the count register.
+         T item = addr[r];
+         readPos = next(r);
+         return item;
+      }
+
+      /**
+       * Moves the next value into dst. Returns 0, leaving dst untouched, when the buffer is empty.
+       */
+      uint8_t pop(T &dst){
+         uint16_t r = readPos;
+
+         if(__builtin_expect(r == writeIndex(), 0)){
+            return 0;
+         }
+
+         RB_BARRIER();
+         dst = addr[r];
+         readPos = next(r);
+         return 1;
+      }
+
+      /**
+       * Reads up to n values into dst, copying in at most two blocks around the end of the array. Returns the number
+       * of elements that were actually read.
+       */
+      size_t read(T *dst, size_t n){
+         span s = peek();
+         size_t part = (s.length > n) ? n : s.length;
+
+         memcpy(dst, s.addr, part * sizeof(T));
+         consume(part);
+
+         if(part < n){
+            s = peek();                         //What is left after the wrap.
+            size_t rest = (s.length > n - part) ? n - part : s.length;
+
+            memcpy(dst + part, s.addr, rest * sizeof(T));
+            consume(rest);
+            part += rest;
+         }
+
+         return part;
+      }
+
+      /**
+       * Borrows the largest block of unread elements that can be read in place. The block never wraps, so once it has
+       * been consumed another call may return the rest of the data; its length is 0 when the buffer is empty.
+       */
+      span peek(){
+         uint16_t r = readPos;
+         uint16_t w = writeIndex();
+         span s = {&addr[r], (uint16_t)((w >= r) ? w - r : arrLen - r)};
+
+         RB_BARRIER();                          //Read the elements only after seeing the count register.
+         return s;
+      }
+
+      /**
+       * Releases the first n elements of the block returned by peek(). n is limited to the number of unread elements.
+       */
+      void consume(uint16_t n){
+         uint16_t avail = size();
+         uint16_t r = readPos + ((n > avail) ? avail : n);
+
+         readPos = (r >= arrLen) ? r - arrLen : r;
+      }
+
+      /**
+       * Drops every unread element, such as after falling more than a lap behind.
+       */
+      inline void flush(){
+         readPos = writeIndex();
+      }
+
+   private:
+      /**
+       * Returns the index following pos, wrapped to the length of the array.
+       */
+      inline uint16_t next(uint16_t pos) const{
+         pos++;
+         return (pos == arrLen) ? 0 : pos;
+      }
+
+      T *addr;                         //The array the DMA controller writes to.
+      uint16_t arrLen;                 //How many elements long the array is.
+      R const volatile *counter;       //The channel's remaining-transfer count.
+      uint16_t readPos;                //The index used for reading from the array.
+};
+
+#endif
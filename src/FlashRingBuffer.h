@@ -0,0 +1,224 @@
+#ifndef FLASH_RING_BUFFER_H
+#define FLASH_RING_BUFFER_H
+
+#include "RingBuffer.h"
+
+#if defined(__AVR__)
+   #include <avr/pgmspace.h>
+#endif
+
+/**
+ * Reads elements out of flash. AVR keeps flash in its own address space, so single elements of 1, 2 and 4 bytes are
+ * read with pgm_read_byte/word/dword and anything else or any block with memcpy_P. Other architectures map flash into
+ * the normal address space, where a table declared const is read directly.
+ */
+template<typename T, uint8_t size = sizeof(T)>
+struct ringFlash{
+   static inline T get(T const *src){
+#if defined(__AVR__)
+      T item;
+      memcpy_P(&item, src, sizeof(T));
+      return item;
+#else
+      return *src;
+#endif
+   }
+
+   static inline void copy(T *dst, T const *src, size_t n){
+#if defined(__AVR__)
+      memcpy_P(dst, src, n * sizeof(T));
+#else
+      memcpy(dst, src, n * sizeof(T));
+#endif
+   }
+};
+
+#if defined(__AVR__)
+template<typename T>
+struct ringFlash<T, 1> : ringFlash<T, 0>{
+   static inline T get(T const *src){
+      T item;
+      uint8_t raw = pgm_read_byte(src);
+      memcpy(&item, &raw, sizeof(T));
+      return item;
+   }
+};
+
+template<typename T>
+struct ringFlash<T, 2> : ringFlash<T, 0>{
+   static inline T get(T const *src){
+      T item;
+      uint16_t raw = pgm_read_word(src);
+      memcpy(&item, &raw, sizeof(T));
+      return item;
+   }
+};
+
+template<typename T>
+struct ringFlash<T, 4> : ringFlash<T, 0>{
+   static inline T get(T const *src){
+      T item;
+      uint32_t raw = pgm_read_dword(src);
+      memcpy(&item, &raw, sizeof(T));
+      return item;
+   }
+};
+#endif
+
+/**
+ * Picks the index type for a FlashRingBuffer. The table is never written, so its index only runs up to the last
+ * element rather than over twice the length as in RingBuffer: tables of up to 255 elements keep a single byte index.
+ * A length only known at runtime uses the same index as a runtime sized RingBuffer.
+ */
+template<size_t N>
+struct ringFlashIndex{
+   typedef typename ringSelect<(N <= 255), uint8_t,
+           typename ringSelect<(N <= 65535), uint16_t, uint32_t>::type>::type type;
+};
+
+template<>
+struct ringFlashIndex<0>{
+   typedef typename ringIndex<0>::type type;
+};
+
+/**
+ * The table a FlashRingBuffer reads from. Its length is only kept in SRAM when it is not known at compile time.
+ */
+template<typename T, size_t N, typename I>
+struct ringFlashTable{
+   T const *addr;                      //The table in flash.
+
+   inline I length() const{
+      return (I)N;
+   }
+};
+
+template<typename T, typename I>
+struct ringFlashTable<T, 0, I>{
+   T const *addr;                      //The table in flash.
+   I arrLen;                           //How many elements long the table is.
+
+   inline I length() const{
+      return arrLen;
+   }
+};
+
+/**
+ * A read-only RingBuffer over a table held in flash (PROGMEM on AVR), such as a waveform or an LED animation that is
+ * played back in a loop. The table is never copied into SRAM; the object only holds the table's address, the read
+ * index and, when it is only known at runtime, the table's length.
+ *
+ * The buffer is always full: read() returns the element at the read index and moves it on, wrapping back to the start
+ * of the table after the last element. As with RingBuffer, a power of two N wraps with a mask and any other length
+ * with a compare-and-reset. Leaving N at 0 takes the length from the constructor instead; that uses a 16 bit index on
+ * AVR and a 32 bit one elsewhere, so pass uint8_t as the third argument for a single byte index on tables of up to 255
+ * elements.
+ *
+ *    const uint8_t sine[64] PROGMEM = {...};
+ *    FlashRingBuffer<uint8_t, 64> wave(sine);
+ *    OCR2A = wave.read();
+ */
+template<typename T, size_t N = 0, typename I = typename ringFlashIndex<N>::type>
+class FlashRingBuffer{
+   static_assert(__is_trivially_copyable(T), "FlashRingBuffer copies elements out of flash as raw bytes.");
+   typedef ringFlash<T> flash;
+
+   public:
+      /**
+       * Construct a new Flash Ring Buffer object over a table of N elements. Requires a length to be given as the
+       * second template argument.
+       */
+      FlashRingBuffer(T const *addr){
+         static_assert(N != 0, "FlashRingBuffer without a compile-time length needs an element count.");
+         table.addr = addr;
+         readPos = 0;
+      };
+
+      /**
+       * Construct a new Flash Ring Buffer object over a table whose length is only known at runtime.
+       */
+      FlashRingBuffer(T const *addr, I elements){
+         static_assert(N == 0, "FlashRingBuffer with a compile-time length takes only the table.");
+         table.addr = addr;
+         table.arrLen = elements;
+         readPos = 0;
+      };
+
+      /**
+       * Read the next value from the table, wrapping back to the first one after the last.
+       */
+      inline T read(){
+         I r = readPos;
+
+         readPos = next(r);
+         return flash::get(&table.addr[r]);
+      }
+
+      /**
+       * Reads the next n values into dst, wrapping around the end of the table as many times as needed. Copied in
+       * blocks that run up to the end of the table.
+       */
+      void read(T *dst, size_t n){
+         I r = readPos;
+
+         while(n){
+            I part = length() - r;
+            if(part > n){
+               part = n;
+            }
+
+            flash::copy(dst, &table.addr[r], part);
+            dst += part;
+            n -= part;
+            r = (r + part == length()) ? 0 : r + part;
+         }
+
+         readPos = r;
+      }
+
+      /**
+       * Returns the value read() would return next, without moving past it.
+       */
+      inline T peek() const{
+         return flash::get(&table.addr[readPos]);
+      }
+
+      /**
+       * Moves the read index to pos, such as to restart an animation. pos must be less than the length of the table.
+       */
+      inline void seek(I pos){
+         readPos = pos;
+      }
+
+      /**
+       * Returns the index of the element read() returns next.
+       */
+      inline I position() const{
+         return readPos;
+      }
+
+      /**
+       * Returns the number of elements in the table.
+       */
+      inline I length() const{
+         return table.length();
+      }
+
+   private:
+      /**
+       * Returns the index following pos, wrapped to the length of the table.
+       */
+      inline I next(I pos) const{
+         if(RB_IS_POW2(N)){
+            return (pos + 1) & (N - 1);
+         }
+
+         pos++;
+         return (pos == length()) ? 0 : pos;
+      }
+
+      ringFlashTable<T, N, I> table;   //The table in flash, and its length when N is 0.
+      I readPos;                       //The index used for reading from the table.
+};
+
+#endif
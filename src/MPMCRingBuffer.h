@@ -0,0 +1,130 @@
+#ifndef MPMC_RING_BUFFER_H
+#define MPMC_RING_BUFFER_H
+
+#include "RingBuffer.h"
+
+#if defined(__AVR__)
+   #error "MPMCRingBuffer needs an atomic compare-and-swap, which AVR does not have. Use RingBuffer with p_write()/p_read()."
+#endif
+
+/**
+ * The size of a cache line. The head and tail counters are kept this far apart, so producers and consumers on
+ * different cores don't keep invalidating each other's copy of the line. Can be defined before including this header.
+ */
+#ifndef RB_CACHE_LINE
+   #define RB_CACHE_LINE      64
+#endif
+
+/**
+ * A bounded ring buffer that any number of producers and consumers can share, such as tasks on both ESP32 cores.
+ * Uses the same write()/read() names as RingBuffer, but both report whether they succeeded, as the indices can move
+ * between a check and the call.
+ *
+ * Every slot carries a sequence number that says whether it is free for the producer of a given turn or filled for
+ * the consumer of that turn (Dmitry Vyukov's bounded MPMC queue). Producers claim a turn by moving the head counter
+ * with a compare-and-swap, and consumers do the same with the tail, so neither side needs a lock. N has to be a power
+ * of two, so the counters wrap onto the array with a mask.
+ */
+template<typename T, size_t N>
+class MPMCRingBuffer{
+   static_assert(RB_IS_POW2(N), "MPMCRingBuffer needs a power of two capacity.");
+
+   public:
+      /**
+       * Construct a new, empty MPMC Ring Buffer object. The array is stored inside the object.
+       */
+      MPMCRingBuffer(){
+         for(size_t i = 0; i < N; i++){
+            cells[i].seq = i;
+         }
+         head = 0;
+         tail = 0;
+      };
+
+      /**
+       * Writes a new value to the RingBuffer. Returns 1 when the value was stored, and 0 when the buffer was full.
+       * Never overwrites unread data.
+       */
+      uint8_t write(T const &data){
+         cell *c;
+         size_t pos = __atomic_load_n(&head, __ATOMIC_RELAXED);
+
+         for(;;){
+            c = &cells[pos & (N - 1)];
+            size_t seq = __atomic_load_n(&c->seq, __ATOMIC_ACQUIRE);
+            intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+
+            if(dif == 0){
+               if(__atomic_compare_exchange_n(&head, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)){
+                  break;                     //This producer owns the slot for this turn.
+               }
+            }else if(dif < 0){
+               return 0;                     //The slot still holds a value from the last lap: full.
+            }else{
+               pos = __atomic_load_n(&head, __ATOMIC_RELAXED);
+            }
+         }
+
+         c->data = data;
+         __atomic_store_n(&c->seq, pos + 1, __ATOMIC_RELEASE);   //Hands the slot to the consumer of this turn.
+         return 1;
+      }
+
+      /**
+       * Reads the next value from the RingBuffer into dst. Returns 1 when a value was read, and 0, leaving dst
+       * untouched, when the buffer was empty.
+       */
+      uint8_t read(T &dst){
+         cell *c;
+         size_t pos = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+
+         for(;;){
+            c = &cells[pos & (N - 1)];
+            size_t seq = __atomic_load_n(&c->seq, __ATOMIC_ACQUIRE);
+            intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+
+            if(dif == 0){
+               if(__atomic_compare_exchange_n(&tail, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)){
+                  break;                     //This consumer owns the slot for this turn.
+               }
+            }else if(dif < 0){
+               return 0;                     //The producer of this turn hasn't filled the slot yet: empty.
+            }else{
+               pos = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+            }
+         }
+
+         dst = c->data;
+         __atomic_store_n(&c->seq, pos + N, __ATOMIC_RELEASE);   //Hands the slot to the producer of the next lap.
+         return 1;
+      }
+
+      /**
+       * Checks if the buffer is full. Only a snapshot, as other producers and consumers may change it right after.
+       */
+      inline uint8_t isFull() const{
+         size_t t = __atomic_load_n(&tail, __ATOMIC_RELAXED);   //Tail first, so head can only have moved further.
+         size_t h = __atomic_load_n(&head, __ATOMIC_RELAXED);
+         return h - t >= N;
+      }
+
+      /**
+       * Checks if the buffer is empty. Only a snapshot, as other producers and consumers may change it right after.
+       */
+      inline uint8_t isEmpty() const{
+         return __atomic_load_n(&head, __ATOMIC_RELAXED) == __atomic_load_n(&tail, __ATOMIC_RELAXED);
+      }
+
+   private:
+      struct cell{
+         size_t seq;                         //The turn this slot is waiting on.
+         T data;
+      };
+
+      alignas(RB_CACHE_LINE) cell cells[N];
+      alignas(RB_CACHE_LINE) size_t head;  //The next turn a producer will claim. Only moved by producers.
+      alignas(RB_CACHE_LINE) size_t tail;  //The next turn a consumer will claim. Only moved by consumers.
+      char pad[RB_CACHE_LINE - sizeof(size_t)];   //Keeps whatever follows the buffer off of the tail's line.
+};
+
+#endif
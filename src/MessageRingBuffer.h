@@ -0,0 +1,203 @@
+#ifndef MESSAGE_RING_BUFFER_H
+#define MESSAGE_RING_BUFFER_H
+
+#include "RingBuffer.h"
+
+/**
+ * A ring of variable length messages, such as radio packets or CAN frames, packed back to back in a byte RingBuffer.
+ * Each message is stored behind a length prefix: one byte for lengths up to 127, two bytes (top bit set, then big
+ * endian) up to 32767. A buffer of small packets then only spends a byte per packet on framing, instead of a fixed
+ * size slot per packet.
+ *
+ * With contiguous left at 1, a message that would run past the end of the array is moved to the start instead, behind
+ * a single zero byte that tells the reader to skip the rest of the array. Every message is then one block, and
+ * readMessage() hands it out in place, but a message and its prefix can only take up to half the array (see
+ * maxMessage()). With contiguous at 0 messages wrap around the end, wasting no space, and are
+ * copied out with readMessage(dst, max).
+ *
+ * A message is published with a single store of the write index, so a single producer and a single consumer (such
+ * as a receive ISR and loop()) can share the buffer, as with p_write() and p_read(). Messages are never overwritten.
+ */
+template<size_t N = 0, uint8_t contiguous = 1>
+class MessageRingBuffer : protected RingBuffer<uint8_t, 1, N, DropNewest>{
+   typedef typename ringIndex<N>::type I;
+   typedef RingBuffer<uint8_t, 1, N, DropNewest> base;
+   typedef typename RingBufferCore<uint8_t, N, DropNewest, I>::ringBuff ringBuff;
+
+   public:
+      typedef typename base::span span;
+      using base::isEmpty;
+
+      /**
+       * Returns the longest message the buffer accepts. With contiguous messages, one that would run past the end of
+       * the array needs the rest of the array as padding too, and only a message and its prefix of up to half the
+       * array is sure to fit once the buffer drains, wherever the write index stopped. 0 when not even a one byte
+       * message and its prefix fit.
+       */
+      inline uint16_t maxMessage() const{
+         I room = contiguous ? this->buff.length() / 2 : this->buff.length();
+         if(room < 2){
+            return 0;
+         }
+         uint16_t len = (room > 0x80) ? room - 2 : room - 1;
+
+         return (len > 0x7FFF) ? 0x7FFF : len;
+      }
+
+      /**
+       * Construct a new Message Ring Buffer object with its array stored inside the object.
+       */
+      MessageRingBuffer(){
+      };
+
+      /**
+       * Construct a new Message Ring Buffer object over the passed array, whose length is only known at runtime.
+       */
+      MessageRingBuffer(uint8_t *arr, I elements) : base(arr, elements){
+      };
+
+      /**
+       * Stores a message of len bytes. Returns 1 when it was stored, and 0, leaving the buffer as it was, when there is
+       * not enough free space or len is 0 or longer than maxMessage().
+       */
+      uint8_t writeMessage(uint8_t const *data, uint16_t len){
+         ringBuff *b = &this->buff;
+         I w = b->writePos;
+         size_t hdr = (len < 0x80) ? 1 : 2;
+         size_t need = hdr + len;
+         size_t space = b->length() - this->count(w, this->load(b->readPos));
+         I index = this->slot(w);
+         I toEnd = b->length() - index;
+
+         if(__builtin_expect(len == 0 || len > 0x7FFF || need > (contiguous ? b->length() / 2 : b->length()), 0)){
+            return 0;                           //Larger contiguous messages could wait on padding that never leaves.
+         }
+
+         if(contiguous && toEnd < need){
+            if(space < toEnd + need){
+               return 0;
+            }
+
+            b->addr[index] = 0;                 //Tells the reader to skip to the start of the array.
+            w = this->advance(w, toEnd);
+            need += toEnd;
+            index = 0;
+         }else if(space < need){
+            return 0;
+         }
+
+         if(hdr == 1){
+            b->addr[index] = len;
+         }else{
+            b->addr[index] = 0x80 | (len >> 8);
+            b->addr[this->slot(this->next(w))] = len & 0xFF;
+         }
+
+         I at = this->slot(this->advance(w, hdr));
+         I part = b->length() - at;
+         if(part > len){
+            part = len;
+         }
+         memcpy(&b->addr[at], data, part);
+         memcpy(&b->addr[0], data + part, len - part);
+
+         RB_BARRIER();                          //The message has to land before the consumer can see the new index.
+         this->store(b->writePos, this->advance(b->writePos, need));
+         return 1;
+      }
+
+      /**
+       * Returns the oldest message in place, without removing it; its length is 0 when the buffer is empty. The block
+       * stays valid until consumeMessage() is called. Needs contiguous messages.
+       */
+      span readMessage(){
+         static_assert(contiguous, "readMessage() needs contiguous messages, use readMessage(dst, max).");
+         ringBuff *b = &this->buff;
+         I len;
+         I hdr = head(len);
+         span s = {&b->addr[this->slot(this->advance(b->readPos, hdr))], len};
+
+         return s;
+      }
+
+      /**
+       * Removes the oldest message, such as after using the block returned by readMessage().
+       */
+      void consumeMessage(){
+         ringBuff *b = &this->buff;
+         I len;
+         I hdr = head(len);
+
+         if(len){
+            RB_BARRIER();                       //The message has to be used before its bytes are handed back.
+            this->store(b->readPos, this->advance(b->readPos, hdr + len));
+         }
+      }
+
+      /**
+       * Copies the oldest message into dst and removes it. At most max bytes are copied, and the rest of a longer
+       * message is dropped. Returns the length of the message, or 0 when the buffer is empty.
+       */
+      uint16_t readMessage(uint8_t *dst, uint16_t max){
+         ringBuff *b = &this->buff;
+         I len;
+         I hdr = head(len);
+
+         if(len == 0){
+            return 0;
+         }
+
+         I at = this->slot(this->advance(b->readPos, hdr));
+         I n = (len > max) ? max : len;
+         I part = b->length() - at;
+         if(part > n){
+            part = n;
+         }
+         memcpy(dst, &b->addr[at], part);
+         memcpy(dst + part, &b->addr[0], n - part);
+
+         RB_BARRIER();                          //The message has to be copied out before its bytes are handed back.
+         this->store(b->readPos, this->advance(b->readPos, hdr + len));
+         return len;
+      }
+
+   private:
+      /**
+       * Finds the oldest message, skipping the padding left at the end of the array. Returns the size of its length
+       * prefix and sets len to its length, which is 0 when the buffer is empty.
+       */
+      I head(I &len){
+         ringBuff *b = &this->buff;
+         I r = b->readPos;
+         I avail = this->count(this->load(b->writePos), r);
+
+         len = 0;
+         if(avail == 0){
+            return 0;
+         }
+
+         RB_BARRIER();                          //Read the message only after seeing the producer's index.
+         I index = this->slot(r);
+         if(contiguous && b->addr[index] == 0){
+            I toEnd = b->length() - index;
+
+            r = this->advance(r, toEnd);        //Padding, the message starts over at the beginning of the array.
+            this->store(b->readPos, r);
+            if(avail == toEnd){
+               return 0;
+            }
+            index = 0;
+         }
+
+         uint8_t first = b->addr[index];
+         if(first < 0x80){
+            len = first;
+            return 1;
+         }
+
+         len = ((first & 0x7F) << 8) | b->addr[this->slot(this->next(r))];
+         return 2;
+      }
+};
+
+#endif
@@ -0,0 +1,205 @@
+#ifndef MIRROR_RING_BUFFER_H
+#define MIRROR_RING_BUFFER_H
+
+#if !defined(__linux__)
+   #error "MirrorRingBuffer maps memory twice with memfd and mmap, which needs Linux. Use RingBuffer elsewhere."
+#endif
+
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+/**
+ * The size of a cache line, see MPMCRingBuffer.h. The two indices are kept this far apart.
+ */
+#ifndef RB_CACHE_LINE
+   #define RB_CACHE_LINE      64
+#endif
+
+/**
+ * A single producer, single consumer ring buffer for Linux hosts, such as test rigs and Raspberry Pi gateways taking
+ * in streams far faster than a microcontroller would.
+ *
+ * The same pages are mapped twice, back to back, so the element after the last one in the array is the first one
+ * again. Any run of up to capacity() elements starting anywhere in the buffer is then contiguous in memory: write(),
+ * read() and the span APIs each come down to a single memcpy or a single pointer, with no wrap to handle.
+ *
+ * The capacity is rounded up to a power of two number of bytes, and at least one page, so the indices wrap with a
+ * mask. The indices count up freely and are shared with acquire/release atomics, as the producer and consumer
+ * usually run on different cores.
+ */
+template<typename T>
+class MirrorRingBuffer{
+   static_assert(__is_trivially_copyable(T), "MirrorRingBuffer copies elements as raw bytes.");
+   static_assert((sizeof(T) & (sizeof(T) - 1)) == 0, "MirrorRingBuffer needs an element size that is a power of two.");
+
+   public:
+      /**
+       * A contiguous block of elements inside the buffer. Never split by the wrap.
+       */
+      struct span{
+         T *addr;                               //The first element of the block.
+         size_t length;                         //How many elements are in the block.
+      };
+
+      /**
+       * Construct a new Mirror Ring Buffer object holding at least the given number of elements. When the mapping
+       * can't be set up, isValid() returns 0 and every write and read moves nothing.
+       */
+      MirrorRingBuffer(size_t elements){
+         size_t page = sysconf(_SC_PAGESIZE);
+         size_t bytes = page;
+
+         while(bytes < elements * sizeof(T)){
+            bytes <<= 1;                        //A power of two that is at least a page is a whole number of pages.
+         }
+
+         addr = 0;
+         len = 0;
+         readPos = 0;
+         writePos = 0;
+
+         int fd = syscall(SYS_memfd_create, "RingBuffer", 0);
+         if(fd < 0){
+            return;
+         }
+
+         uint8_t *base = 0;
+         if(ftruncate(fd, bytes) == 0){
+            void *area = mmap(0, 2 * bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);   //Reserves both halves.
+
+            if(area != MAP_FAILED){
+               base = (uint8_t *)area;
+               if(mmap(base, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+                  mmap(base + bytes, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED){
+                  munmap(base, 2 * bytes);
+                  base = 0;
+               }
+            }
+         }
+         close(fd);                             //The mappings keep the pages alive.
+
+         if(base){
+            addr = (T *)base;
+            len = bytes / sizeof(T);
+         }
+      }
+
+      ~MirrorRingBuffer(){
+         if(addr){
+            munmap(addr, 2 * len * sizeof(T));
+         }
+      }
+
+      /**
+       * Returns 1 when the mirrored mapping was set up.
+       */
+      inline uint8_t isValid() const{
+         return addr != 0;
+      }
+
+      /**
+       * Returns how many elements the buffer holds, after rounding up.
+       */
+      inline size_t capacity() const{
+         return len;
+      }
+
+      /**
+       * Writes up to n values from src to the buffer. Never overwrites unread data, and returns the number of elements
+       * that were actually stored. Only call from the producer.
+       */
+      size_t write(T const *src, size_t n){
+         span s = reserve(n);
+
+         memcpy(s.addr, src, s.length * sizeof(T));
+         commit(s.length);
+         return s.length;
+      }
+
+      /**
+       * Reads up to n values from the buffer into dst. Returns the number of elements that were actually read. Only
+       * call from the consumer.
+       */
+      size_t read(T *dst, size_t n){
+         span s = peek();
+
+         if(s.length > n){
+            s.length = n;
+         }
+         memcpy(dst, s.addr, s.length * sizeof(T));
+         consume(s.length);
+         return s.length;
+      }
+
+      /**
+       * Borrows up to n free elements for writing in place. The block covers all of the free space when n allows.
+       * Nothing becomes readable until commit() is called.
+       */
+      span reserve(size_t n){
+         size_t w = writePos;
+         size_t space = len - (w - __atomic_load_n(&readPos, __ATOMIC_ACQUIRE));
+         span s = {&addr[w & (len - 1)], (n > space) ? space : n};
+
+         return s;
+      }
+
+      /**
+       * Hands the first n elements of the block returned by reserve() over to the consumer.
+       */
+      void commit(size_t n){
+         size_t w = writePos;
+         size_t space = len - (w - __atomic_load_n(&readPos, __ATOMIC_ACQUIRE));
+
+         __atomic_store_n(&writePos, w + ((n > space) ? space : n), __ATOMIC_RELEASE);
+      }
+
+      /**
+       * Borrows every unread element as one block. The elements stay in the buffer until consume() is called.
+       */
+      span peek(){
+         size_t r = readPos;
+         span s = {&addr[r & (len - 1)], __atomic_load_n(&writePos, __ATOMIC_ACQUIRE) - r};
+
+         return s;
+      }
+
+      /**
+       * Releases the first n elements of the block returned by peek() back to the producer.
+       */
+      void consume(size_t n){
+         size_t r = readPos;
+         size_t avail = __atomic_load_n(&writePos, __ATOMIC_ACQUIRE) - r;
+
+         __atomic_store_n(&readPos, r + ((n > avail) ? avail : n), __ATOMIC_RELEASE);
+      }
+
+      /**
+       * Returns the number of unread elements. Only a snapshot when called from outside the consumer.
+       */
+      inline size_t size() const{
+         size_t r = __atomic_load_n(&readPos, __ATOMIC_ACQUIRE);   //Read first, so writePos can only have moved further.
+         return __atomic_load_n(&writePos, __ATOMIC_ACQUIRE) - r;
+      }
+
+      inline uint8_t isFull() const{
+         return size() == len;
+      }
+
+      inline uint8_t isEmpty() const{
+         return size() == 0;
+      }
+
+   private:
+      MirrorRingBuffer(MirrorRingBuffer const &);               //Owns its mapping, so it can't be copied.
+      MirrorRingBuffer &operator=(MirrorRingBuffer const &);
+
+      T *addr;                         //The first of the two mappings of the array.
+      size_t len;                      //How many elements long the array is, a power of two.
+      alignas(RB_CACHE_LINE) size_t readPos;    //Counts every element read. Only stored by the consumer.
+      alignas(RB_CACHE_LINE) size_t writePos;   //Counts every element written. Only stored by the producer.
+};
+
+#endif
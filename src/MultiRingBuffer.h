@@ -0,0 +1,191 @@
+#ifndef MULTI_RING_BUFFER_H
+#define MULTI_RING_BUFFER_H
+
+#include "RingBuffer.h"
+
+/**
+ * A RingBuffer for C channels sampled together, such as several ADC inputs read on every tick. All channels share one
+ * read and write index, so storing a frame of C samples is one full check and one index store instead of C. Each
+ * channel has its own array of N samples (structure of arrays), so a block of one channel is contiguous and can be
+ * handed to DSP routines such as CMSIS-DSP as is.
+ *
+ *    MultiRingBuffer<int16_t, 6, 64> adc;
+ *    adc.p_write(a0, a1, a2, a3, a4, a5);          //In the ADC ISR.
+ *
+ *    MultiRingBuffer<int16_t, 6, 64>::span s = adc.peek();
+ *    arm_mean_q15(adc.channel(2) + s.index, s.length, &mean);
+ *    adc.consume(s.length);
+ *
+ * Follows the same single producer and consumer rules as RingBuffer: p_write() and the reads can be shared between
+ * an ISR and loop().
+ */
+template<typename T, uint8_t C, size_t N, typename I = typename ringIndex<N>::type>
+class MultiRingBuffer{
+   static_assert(C != 0 && N != 0, "MultiRingBuffer needs a channel count and a compile-time capacity.");
+   typedef ringWrap<N, I> wrap;
+
+   public:
+      /**
+       * A block of frames that is contiguous in every channel: channel(c)[index] up to channel(c)[index + length - 1].
+       */
+      struct span{
+         I index;                               //The first frame of the block.
+         I length;                              //How many frames are in the block.
+      };
+
+      /**
+       * Construct a new, empty Multi Ring Buffer object. The arrays are stored inside the object.
+       */
+      MultiRingBuffer(){
+         pos.readPos = 0;
+         pos.writePos = 0;
+      };
+
+      /**
+       * Writes a frame of C samples, one per channel. When the buffer is full, overrides the oldest frame, moving the
+       * read index past it. Returns the next write index.
+       *
+       * As it can move the read index, it is not safe to call while a consumer reads from another context; use
+       * p_write() for that.
+       */
+      I write(T const *frame){
+         I w = pos.writePos;
+         I r = ringLoad(pos.readPos);
+
+         if(__builtin_expect(wrap::full(w, r), 0)){
+            ringStore(pos.readPos, wrap::next(r));    //Drops the oldest frame to make room.
+         }
+
+         put(wrap::slot(w), frame);
+         w = wrap::next(w);
+         ringStore(pos.writePos, w);
+         return wrap::slot(w);
+      }
+
+      /**
+       * Writes a frame of C samples, with protection. When the buffer is full, drops the frame and returns the current
+       * write index instead of the next.
+       */
+      I p_write(T const *frame){
+         I w = pos.writePos;
+
+         if(__builtin_expect(wrap::full(w, ringLoad(pos.readPos)), 0)){
+            return wrap::slot(w);
+         }
+
+         put(wrap::slot(w), frame);
+         w = wrap::next(w);
+         RB_BARRIER();                          //The frame has to land before the consumer can see the new index.
+         ringStore(pos.writePos, w);
+
+         return wrap::slot(w);
+      }
+
+      /**
+       * Writes a frame passed as C separate samples, such as write(a0, a1, a2).
+       */
+      template<typename... A>
+      inline I write(T first, A... rest){
+         static_assert(sizeof...(A) + 1 == C, "write() takes one sample per channel.");
+         T frame[C] = {first, (T)rest...};
+         return write((T const *)frame);
+      }
+
+      template<typename... A>
+      inline I p_write(T first, A... rest){
+         static_assert(sizeof...(A) + 1 == C, "p_write() takes one sample per channel.");
+         T frame[C] = {first, (T)rest...};
+         return p_write((T const *)frame);
+      }
+
+      /**
+       * Reads the oldest frame into frame, one sample per channel. Returns 0, leaving frame untouched, when the buffer
+       * is empty.
+       */
+      uint8_t read(T *frame){
+         I r = pos.readPos;
+
+         if(__builtin_expect(r == ringLoad(pos.writePos), 0)){
+            return 0;
+         }
+
+         RB_BARRIER();                          //Read the frame only after seeing the producer's index.
+         I index = wrap::slot(r);
+         for(uint8_t c = 0; c < C; c++){
+            frame[c] = addr[c][index];
+         }
+         RB_BARRIER();                          //The frame has to be copied out before the slot is handed back.
+         ringStore(pos.readPos, wrap::next(r));
+
+         return 1;
+      }
+
+      /**
+       * Returns the array of samples for channel c, N samples long. Use with the index and length returned by peek().
+       */
+      inline T *channel(uint8_t c){
+         return addr[c];
+      }
+
+      /**
+       * Borrows the largest block of unread frames that is contiguous in every channel. The block never wraps, so once
+       * it has been consumed another call may return the rest of the data; its length is 0 when the buffer is empty.
+       */
+      span peek(){
+         I r = pos.readPos;
+         I avail = wrap::count(ringLoad(pos.writePos), r);
+         span s = {wrap::slot(r), (I)(N - wrap::slot(r))};
+
+         if(s.length > avail){
+            s.length = avail;
+         }
+
+         RB_BARRIER();                          //Read the frames only after seeing the producer's index.
+         return s;
+      }
+
+      /**
+       * Releases the first n frames of the block returned by peek() back to the writer.
+       */
+      void consume(I n){
+         I r = pos.readPos;
+         I avail = wrap::count(ringLoad(pos.writePos), r);
+
+         if(n > avail){
+            n = avail;
+         }
+
+         RB_BARRIER();                          //The frames have to be used before the slots are handed back.
+         ringStore(pos.readPos, wrap::advance(r, n));
+      }
+
+      /**
+       * Returns the number of unread frames.
+       */
+      inline I size() const{
+         return wrap::count(ringLoad(pos.writePos), ringLoad(pos.readPos));
+      }
+
+      inline uint8_t isFull() const{
+         return wrap::full(ringLoad(pos.writePos), ringLoad(pos.readPos));
+      }
+
+      inline uint8_t isEmpty() const{
+         return ringLoad(pos.writePos) == ringLoad(pos.readPos);
+      }
+
+   private:
+      /**
+       * Stores a frame at slot index, one sample into each channel's array.
+       */
+      inline void put(I index, T const *frame){
+         for(uint8_t c = 0; c < C; c++){
+            addr[c][index] = frame[c];
+         }
+      }
+
+      ringIndices<I> pos;              //The read and write indices, shared by every channel.
+      T addr[C][N];                    //One array per channel.
+};
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef PRIORITY_RING_SET_H
+#define PRIORITY_RING_SET_H
+
+#include "RingBuffer.h"
+
+/**
+ * Sets and clears bits in a map shared between a producer and a consumer in different contexts. AVR and Cortex-M hold
+ * interrupts off with RB_LOCK (RB_LOCKS 1) for the couple of cycles it takes, as ARMv6-M (Cortex-M0/M0+) and AVR have
+ * no atomic read-modify-write; elsewhere the compiler's atomics are used.
+ */
+template<typename M>
+inline void ringSetBits(volatile M &map, M bits){
+#if RB_LOCKS == 1
+   RB_LOCK(state);
+   map |= bits;
+   RB_UNLOCK(state);
+#else
+   __atomic_fetch_or(&map, bits, __ATOMIC_SEQ_CST);
+#endif
+}
+
+template<typename M>
+inline void ringClearBits(volatile M &map, M bits){
+#if RB_LOCKS == 1
+   RB_LOCK(state);
+   map &= (M)~bits;
+   RB_UNLOCK(state);
+#else
+   __atomic_fetch_and(&map, (M)~bits, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * A set of Levels RingBuffers, one per priority, each holding up to N values, such as a command dispatcher that has
+ * to serve urgent commands first. A bitmap tracks which levels hold data, so read() finds the most urgent one with a
+ * single count-leading-zeros, however many levels there are, instead of scanning the empty ones in order.
+ *
+ * Higher levels are more urgent: read() always takes from the highest level holding data, and within a level values
+ * come out in the order they were written.
+ *
+ *    PriorityRingSet<command, 4, 16> cmds;
+ *    cmds.write(3, stop);                   //Served before anything waiting on levels 0 to 2.
+ *    while(cmds.read(c)){ ... }
+ *
+ * Like RingBuffer, a single producer and a single consumer (such as an ISR and loop()) can share the set. The writer
+ * only ever sets a level's bit, after storing the value. The reader clears it when the level runs dry, then looks at
+ * the level again, so a value written in between keeps its bit set.
+ */
+template<typename T, uint8_t Levels, size_t N, typename I = typename ringIndex<N>::type>
+class PriorityRingSet{
+   static_assert(Levels != 0 && Levels <= 32, "PriorityRingSet takes 1 to 32 levels.");
+   static_assert(N != 0, "PriorityRingSet needs a compile-time capacity.");
+
+   public:
+      typedef typename ringSelect<(Levels <= 8), uint8_t,
+              typename ringSelect<(Levels <= 16), uint16_t, uint32_t>::type>::type mask_t;
+
+      /**
+       * Construct a new, empty Priority Ring Set object. Every level stores its own array inside the object.
+       */
+      PriorityRingSet(){
+         map = 0;
+      };
+
+      /**
+       * Stores a copy of data at the given level. Returns 1 when it was stored, and 0 when that level is full or does
+       * not exist. Never overwrites unread data.
+       */
+      uint8_t write(uint8_t level, T const &data){
+         if(__builtin_expect(level >= Levels || rings[level].emplace(data) == rings[level].writeError, 0)){
+            return 0;
+         }
+
+         ringSetBits(map, (mask_t)((mask_t)1 << level));
+         return 1;
+      }
+
+      /**
+       * Moves the oldest value of the most urgent level holding data into dst. Returns 0, leaving dst untouched, when
+       * every level is empty.
+       */
+      inline uint8_t read(T &dst){
+         uint8_t level;
+
+         return read(dst, level);
+      }
+
+      /**
+       * Same as read(dst), and also sets level to the level the value was taken from.
+       */
+      uint8_t read(T &dst, uint8_t &level){
+         mask_t m;
+
+         while((m = ringLoad(map)) != 0){
+            level = top(m);
+            uint8_t got = rings[level].pop(dst);
+
+            if(!got || rings[level].isEmpty()){
+               settle(level);
+            }
+            if(got){
+               return 1;
+            }
+         }
+
+         return 0;
+      }
+
+      /**
+       * Returns the most urgent level holding data, or -1 when every level is empty.
+       */
+      inline int8_t top() const{
+         mask_t m = ringLoad(map);
+
+         return m ? (int8_t)top(m) : -1;
+      }
+
+      /**
+       * Returns the bitmap of levels holding data, bit n for level n.
+       */
+      inline mask_t levels() const{
+         return ringLoad(map);
+      }
+
+      /**
+       * Returns the number of unread values at the given level.
+       */
+      inline I size(uint8_t level) const{
+         return rings[level].size();
+      }
+
+      inline uint8_t isFull(uint8_t level) const{
+         return rings[level].isFull();
+      }
+
+      inline uint8_t isEmpty() const{
+         return ringLoad(map) == 0;
+      }
+
+   private:
+      /**
+       * Returns the highest set bit of a non-zero map.
+       */
+      static inline uint8_t top(mask_t m){
+         return (uint8_t)(sizeof(unsigned long) * 8 - 1 - __builtin_clzl((unsigned long)m));
+      }
+
+      /**
+       * Clears the bit of a level that looked empty, then sets it again if the writer stored a value in the meantime.
+       */
+      inline void settle(uint8_t level){
+         mask_t bit = (mask_t)1 << level;
+
+         ringClearBits(map, bit);
+         RB_BARRIER();                          //The bit has to be clear before looking at the level again.
+         if(__builtin_expect(!rings[level].isEmpty(), 0)){
+            ringSetBits(map, bit);
+         }
+      }
+
+      RingBuffer<T, 0, N, ReturnError, I> rings[Levels];  //One ring per level, the most urgent last.
+      volatile mask_t map;                                //Bit n is set while level n holds data.
+};
+
+#endif
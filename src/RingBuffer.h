@@ -1,46 +1,1613 @@
 #ifndef RING_BUFFER_H
 #define RING_BUFFER_H
 
-#include "Arduino.h"
+/**
+ * Arduino cores provide the fixed width types, memcpy and yield() through Arduino.h. Anywhere else, such as a native
+ * build on the host for testing and benchmarking, or an ESP-IDF or Zephyr project, the standard headers stand in.
+ */
+#if defined(ARDUINO)
+   #include "Arduino.h"
+#else
+   #include <stdint.h>
+   #include <stddef.h>
+   #include <string.h>
+   #if defined(__AVR__)
+      #include <avr/io.h>
+      #include <avr/interrupt.h>
+   #endif
+#endif
+
+/**
+ * What the Block policy calls while it waits for the reader to make room. Defaults to yield() on Arduino, which lets
+ * other tasks or the cooperative scheduler run, and to sched_yield() on hosts with POSIX threads. Define it before
+ * including this header to wait some other way, such as taskYIELD() under FreeRTOS.
+ */
+#ifndef RB_YIELD
+   #if defined(ARDUINO)
+      #define RB_YIELD()          yield()
+   #elif defined(__unix__) || defined(__APPLE__)
+      #include <sched.h>
+      #define RB_YIELD()          sched_yield()
+   #else
+      #define RB_YIELD()          (void)0
+   #endif
+#endif
+
+/**
+ * Placement new, which the ARDUINO AVR core ships as new.h. avr-libc has no C++ library, so a plain avr-gcc build
+ * declares its own unless a <new> is found.
+ */
+#if defined(__AVR__) && defined(ARDUINO)
+   #include <new.h>
+#elif defined(__AVR__) && defined(__has_include)
+   #if __has_include(<new>)
+      #include <new>
+   #else
+      #define RB_OWN_PLACEMENT_NEW
+   #endif
+#elif defined(__AVR__)
+   #define RB_OWN_PLACEMENT_NEW
+#else
+   #include <new>
+   #include <iterator>
+#endif
+
+#if defined(RB_OWN_PLACEMENT_NEW)
+inline void *operator new(size_t, void *ptr) noexcept{
+   return ptr;
+}
+#endif
+
+/**
+ * Build profile, picked by defining one of these before including RingBuffer.h. Without either, inlining is left to
+ * the compiler as usual.
+ * 
+ * RB_OPTIMIZE_SPEED:   The single element paths (write(), p_write(), read(), p_read(), emplace() and pop()) are
+ *                      forced inline at every call site, so no call overhead is paid on the hot path. Matters at -Os,
+ *                      as Arduino builds use; at -O2 the compiler inlines them anyway.
+ * RB_OPTIMIZE_SIZE:    Buffers of trivially copyable elements run write(), p_write(), read(), p_read(), pop() and
+ *                      the bulk write() and read() through ringErased, one out of line copy per index type shared by
+ *                      every element type and capacity. Word copies default to off. The shared copy costs a few
+ *                      hundred bytes up front, so this only saves flash once a sketch has three or four buffer types
+ *                      or more; with one or two it is bigger than the default. The README has figures from an x86-64
+ *                      host; this has not been measured on AVR.
+ */
+#if defined(RB_OPTIMIZE_SIZE) && defined(RB_OPTIMIZE_SPEED)
+   #error "Define only one of RB_OPTIMIZE_SIZE and RB_OPTIMIZE_SPEED."
+#endif
+
+#if defined(RB_OPTIMIZE_SPEED)
+   #define RB_PATH             inline __attribute__((__always_inline__))
+#else
+   #define RB_PATH             inline
+#endif
+
+#define CLEAR_BITMASK(x, y)    (x &= (~y))
+#define SET_BITMASK(x, y)      (x |= (y))
+#define CHECK_BITMASK(x, y)    (x & (y))
+
+#define RB_IS_POW2(n)          (((n) != 0) && (((n) & ((n) - 1)) == 0))
+
+/**
+ * Orders the element access before the index store that hands it over to the other side. On AVR, and other single
+ * core parts, keeping the compiler from reordering is enough. Multi-core parts (such as the ESP32) need a full fence.
+ */
+#if defined(__AVR__)
+   #define RB_BARRIER()        __asm__ __volatile__("" ::: "memory")
+#else
+   #define RB_BARRIER()        __sync_synchronize()
+#endif
+
+/**
+ * Holds off interrupts, and the other core where there is one, for the few cycles of an update an ISR must not see
+ * half of: RB_LOCK(state) takes the lock into a new variable and RB_UNLOCK(state) releases it, and both are safe inside
+ * an ISR. RB_LOCKS tells what the pair does:
+ * 
+ * 1:    Saves and disables interrupts: SREG on AVR and PRIMASK on Cortex-M. On a dual core part such as the RP2040
+ *       it only holds off the interrupts of the calling core.
+ * 2:    Takes a spinlock critical section shared by every buffer (portENTER_CRITICAL_SAFE), on ESP32 parts under
+ *       ESP-IDF or the Arduino core, which also keeps out tasks and ISRs on the other core.
+ * 0:    Nothing, on any other target.
+ * 
+ * Define RB_LOCKS, RB_LOCK and RB_UNLOCK before including this header to use another lock, such as the critical
+ * section of an RTOS port.
+ */
+#if defined(RB_LOCK)
+   #if !defined(RB_LOCKS) || !defined(RB_UNLOCK)
+      #error "Define RB_LOCKS and RB_UNLOCK along with RB_LOCK."
+   #endif
+#elif defined(__AVR__)
+   #define RB_LOCKS                 1
+   #define RB_LOCK(state)           uint8_t state = SREG; cli()
+   #define RB_UNLOCK(state)         SREG = state
+#elif defined(__ARM_ARCH_PROFILE) && __ARM_ARCH_PROFILE == 'M'
+   #define RB_LOCKS                 1
+   #define RB_LOCK(state)           uint32_t state; __asm__ __volatile__("mrs %0, primask\n\tcpsid i" : "=r" (state) :: "memory")
+   #define RB_UNLOCK(state)         __asm__ __volatile__("msr primask, %0" :: "r" (state) : "memory")
+#elif defined(ESP_PLATFORM)
+   #include "freertos/FreeRTOS.h"
+
+   inline portMUX_TYPE &ringMux(){
+      static portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+      return mux;
+   }
+
+   #define RB_LOCKS                 2
+   #define RB_LOCK(state)           portMUX_TYPE &state = ringMux(); portENTER_CRITICAL_SAFE(&state)
+   #define RB_UNLOCK(state)         portEXIT_CRITICAL_SAFE(&state)
+#else
+   #define RB_LOCKS                 0
+   #define RB_LOCK(state)           (void)0
+   #define RB_UNLOCK(state)         (void)0
+#endif
+
+/**
+ * Set under ThreadSanitizer, which does not see the ordering RB_BARRIER() gives. ringLoad() and ringStore() then hand
+ * the indices over with acquire and release atomics it understands, so only real races are reported.
+ */
+#if defined(__SANITIZE_THREAD__)
+   #define RB_TSAN
+#elif defined(__has_feature)
+   #if __has_feature(thread_sanitizer)
+      #define RB_TSAN
+   #endif
+#endif
+
+/**
+ * Overflow policies for write(). Passed as a template argument, so the choice is made at compile time and the write
+ * path only keeps the branch for the selected policy.
+ * 
+ * OverwriteOldest:  Stores the new value, dropping the oldest unread one. The default.
+ * DropNewest:       Keeps the buffer as it is and returns the current write index, the same as p_write().
+ * ReturnError:      Keeps the buffer as it is and returns writeError.
+ * Block:            Waits, calling RB_YIELD(), until the reader makes room. Only for use outside of an ISR, on targets
+ *                   where the reader runs in another task or interrupt.
+ */
+#define RB_OVERWRITE   0
+#define RB_DROP        1
+#define RB_ERROR       2
+#define RB_BLOCK       3
+
+struct OverwriteOldest{
+   enum{onFull = RB_OVERWRITE};
+};
+
+struct DropNewest{
+   enum{onFull = RB_DROP};
+};
+
+struct ReturnError{
+   enum{onFull = RB_ERROR};
+};
+
+struct Block{
+   enum{onFull = RB_BLOCK};
+};
+
+/**
+ * Picks the index type for a RingBuffer. Indices run over twice the capacity, so a compile-time capacity of up to 128
+ * keeps the single byte indices AVR is fastest with, and larger capacities move up to 16 or 32 bits. When the capacity
+ * is only known at runtime, AVR uses 16 bit indices, so any array the baseline took (up to 255 elements) still fits,
+ * and other architectures use their native 32 bit word.
+ */
+template<bool select, typename A, typename B>
+struct ringSelect{
+   typedef A type;
+};
+
+template<typename A, typename B>
+struct ringSelect<false, A, B>{
+   typedef B type;
+};
+
+template<size_t N>
+struct ringIndex{
+   typedef typename ringSelect<(N <= 128), uint8_t,
+           typename ringSelect<(N <= 32768), uint16_t, uint32_t>::type>::type type;
+};
+
+template<>
+struct ringIndex<0>{
+#if defined(__AVR__)
+   typedef uint16_t type;
+#else
+   typedef uint32_t type;
+#endif
+};
+
+/**
+ * How the elements of a RingBuffer are created and destroyed.
+ * 
+ * RB_LIFE_TRIVIAL:  Trivially copyable types, copied as raw bytes with ringCopy().
+ * RB_LIFE_ASSIGN:   Other types in an array handed over by the user. Every element of that array is already
+ *                   constructed, so values are assigned (or move assigned) into it.
+ * RB_LIFE_RAW:      Other types in an array stored inside the object. The array is left unconstructed, and an element
+ *                   only lives between being written and being read: it is constructed in place and destroyed once read.
+ */
+#define RB_LIFE_TRIVIAL    0
+#define RB_LIFE_ASSIGN     1
+#define RB_LIFE_RAW        2
+
+#define RB_LIFE(T, N)      (__is_trivially_copyable(T) ? RB_LIFE_TRIVIAL : ((N) == 0 ? RB_LIFE_ASSIGN : RB_LIFE_RAW))
+
+/**
+ * Whether an element can still be looked at through a pointer after its slot has been released. Only false for types
+ * with a destructor stored inside the object, which have to be taken out with pop() or read(dst, n) instead.
+ */
+#define RB_BORROWABLE(T, N)   (RB_LIFE(T, N) != RB_LIFE_RAW || __has_trivial_destructor(T))
+
+/**
+ * Stand-ins for std::move and std::forward, which are not available on every Arduino core.
+ */
+template<typename T>
+struct ringBare{
+   typedef T type;
+};
+
+template<typename T>
+struct ringBare<T &>{
+   typedef T type;
+};
+
+template<typename T>
+struct ringBare<T &&>{
+   typedef T type;
+};
+
+template<typename T>
+inline typename ringBare<T>::type &&ringMove(T &&value){
+   return static_cast<typename ringBare<T>::type &&>(value);
+}
+
+template<typename T>
+inline T &&ringForward(typename ringBare<T>::type &value){
+   return static_cast<T &&>(value);
+}
+
+/**
+ * Block copies for the bulk paths on 32 bit parts. Some C libraries (newlib-nano on most Cortex-M cores, among them)
+ * build memcpy for size and copy a byte at a time, which costs more than the DSP on a block of audio samples. When both
+ * pointers share their alignment, ringCopy() moves whole words instead, four at a time so GCC can turn them into
+ * LDM/STM bursts on ARM. Define RB_WORD_COPY as 0 to always use memcpy; AVR always does.
+ */
+#ifndef RB_WORD_COPY
+   #if defined(RB_OPTIMIZE_SIZE)
+      #define RB_WORD_COPY     0
+   #elif defined(__arm__) || defined(__XTENSA__) || defined(__riscv)
+      #define RB_WORD_COPY     1
+   #else
+      #define RB_WORD_COPY     0
+   #endif
+#endif
+
+typedef uint32_t __attribute__((__may_alias__)) ringWord;
+
+inline void ringCopy(void *dst, void const *src, size_t bytes){
+#if RB_WORD_COPY
+   uint8_t *d = (uint8_t *)dst;
+   uint8_t const *s = (uint8_t const *)src;
+
+   if(((((uintptr_t)d ^ (uintptr_t)s) & 3) == 0) && bytes >= 16){
+      size_t lead = (4 - ((uintptr_t)d & 3)) & 3;   //A 16 bit sample or two before the first whole word.
+
+      memcpy(d, s, lead);
+      d += lead;
+      s += lead;
+      bytes -= lead;
+
+      ringWord *wd = (ringWord *)d;
+      ringWord const *ws = (ringWord const *)s;
+      for(; bytes >= 16; bytes -= 16){
+         ringWord a = ws[0], b = ws[1], c = ws[2], e = ws[3];   //All loads first, so they can share one LDM.
+         wd[0] = a;
+         wd[1] = b;
+         wd[2] = c;
+         wd[3] = e;
+         wd += 4;
+         ws += 4;
+      }
+      for(; bytes >= 4; bytes -= 4){
+         *wd++ = *ws++;
+      }
+
+      d = (uint8_t *)wd;
+      s = (uint8_t const *)ws;
+   }
+
+   memcpy(d, s, bytes);
+#else
+   memcpy(dst, src, bytes);
+#endif
+}
+
+/**
+ * Element lifetime and block copies for each RB_LIFE mode. The bulk paths copy in and out through these, so trivially
+ * copyable types keep a single ringCopy() per block.
+ */
+template<typename T, uint8_t life>
+struct ringLife{
+   template<typename... A>
+   static inline void make(T *slot, A&&... args){
+      *slot = T(ringForward<A>(args)...);
+   }
+
+   static inline void drop(T *){
+   }
+
+   static inline void copyIn(T *dst, T const *src, size_t n){
+      ringCopy(dst, src, n * sizeof(T));
+   }
+
+   static inline void copyOut(T *dst, T *src, size_t n){
+      ringCopy(dst, src, n * sizeof(T));
+   }
+};
+
+template<typename T>
+struct ringLife<T, RB_LIFE_ASSIGN>{
+   template<typename... A>
+   static inline void make(T *slot, A&&... args){
+      *slot = T(ringForward<A>(args)...);
+   }
+
+   static inline void make(T *slot, T const &value){
+      *slot = value;
+   }
+
+   static inline void make(T *slot, T &value){
+      *slot = value;
+   }
+
+   static inline void make(T *slot, T &&value){
+      *slot = ringMove(value);
+   }
+
+   static inline void drop(T *){
+   }
+
+   static inline void copyIn(T *dst, T const *src, size_t n){
+      while(n--){
+         *dst++ = *src++;
+      }
+   }
+
+   static inline void copyOut(T *dst, T *src, size_t n){
+      while(n--){
+         *dst++ = ringMove(*src++);
+      }
+   }
+};
+
+template<typename T>
+struct ringLife<T, RB_LIFE_RAW>{
+   template<typename... A>
+   static inline void make(T *slot, A&&... args){
+      ::new((void *)slot) T(ringForward<A>(args)...);
+   }
+
+   static inline void drop(T *slot){
+      slot->~T();
+   }
+
+   static inline void copyIn(T *dst, T const *src, size_t n){
+      while(n--){
+         make(dst++, *src++);
+      }
+   }
+
+   static inline void copyOut(T *dst, T *src, size_t n){
+      while(n--){
+         *dst++ = ringMove(*src);
+         drop(src++);
+      }
+   }
+};
+
+/**
+ * A conversion for read(dst, n, convert) that scales each element into D, such as int16_t samples into floats:
+ * audio.read(out, 64, ringGain<float>{1.0f / 32768}).
+ */
+template<typename D>
+struct ringGain{
+   D gain;                             //What each element is multiplied by.
+
+   template<typename T>
+   inline D operator()(T const &value) const{
+      return (D)value * gain;
+   }
+};
+
+/**
+ * The read and write indices of a RingBuffer.
+ */
+template<typename I>
+struct ringIndices{
+   volatile I readPos;                 //The index used for reading from the buffer. Only stored by the reader.
+   volatile I writePos;                //The index used for writing from the buffer. Only stored by the writer.
+};
+
+/**
+ * Reads an index stored by the other side of a buffer. Single byte indices, and anything up to the native word on
+ * larger architectures, are read in one access. On AVR a wider index is read until two reads agree, as an interrupt
+ * may update it between its bytes.
+ */
+template<typename I>
+inline I ringLoad(volatile I const &pos){
+#if defined(RB_TSAN)
+   return __atomic_load_n(&pos, __ATOMIC_ACQUIRE);      //Tells ThreadSanitizer about the handover RB_BARRIER() makes.
+#elif defined(__AVR__)
+   if(sizeof(I) > 1){
+      I value;
+      do{
+         value = pos;
+      }while(value != pos);
+      return value;
+   }
+#endif
+   return pos;
+}
+
+/**
+ * Stores an index for the other side of a buffer. On AVR a wider index is stored with interrupts held off for the few
+ * cycles it takes, so an ISR never sees half of it.
+ */
+template<typename I>
+inline void ringStore(volatile I &pos, I value){
+#if defined(RB_TSAN)
+   __atomic_store_n(&pos, value, __ATOMIC_RELEASE);
+   return;
+#elif defined(__AVR__)
+   if(sizeof(I) > 1){
+      RB_LOCK(state);
+      pos = value;
+      RB_UNLOCK(state);
+      return;
+   }
+#endif
+   pos = value;
+}
+
+/**
+ * Index wrapping for a capacity known at compile time: indices run over twice the capacity, and a power of two N wraps
+ * with a mask. Used by RingBufferCore whenever N is given, and by the buffers built beside RingBuffer.
+ */
+template<size_t N, typename I>
+struct ringWrap{
+   static_assert(N <= ((size_t)(I)~(I)0 >> 1) + 1, "RingBuffer indices need to hold twice the capacity.");
+
+   static inline I next(I pos){
+      if(RB_IS_POW2(N)){
+         return (pos + 1) & (2 * N - 1);
+      }
+
+      pos++;
+      return (pos == 2 * N) ? 0 : pos;
+   }
+
+   static inline I slot(I pos){
+      if(RB_IS_POW2(N)){
+         return pos & (N - 1);
+      }
+
+      return (pos >= N) ? pos - N : pos;
+   }
+
+   static inline I advance(I pos, I n){
+      if(RB_IS_POW2(N)){
+         return (pos + n) & (2 * N - 1);
+      }
+
+      I limit = 2 * N - n;
+      return (pos >= limit) ? pos - limit : pos + n;
+   }
+
+   static inline I count(I w, I r){
+      if(RB_IS_POW2(N)){
+         return (w - r) & (2 * N - 1);
+      }
+
+      return (w >= r) ? w - r : w + 2 * N - r;
+   }
+
+   static inline uint8_t full(I w, I r){
+      if(RB_IS_POW2(N)){
+         return (I)(w ^ r) == N;
+      }
+
+      return count(w, r) == N;
+   }
+};
+
+#if defined(RB_OPTIMIZE_SIZE)
+/**
+ * The shared core of RB_OPTIMIZE_SIZE. Every RingBuffer of trivially copyable elements with the same index type runs
+ * through these few functions, whatever its element type and capacity: the array, its length and the element size
+ * are passed in, elements are moved as bytes, and the indices wrap with a compare-and-reset. A buffer's own methods
+ * shrink to a call, so a sketch with several buffers carries one copy of each path instead of one per buffer type.
+ * Not used with RB_WATERMARKS, RB_STATS or RB_SNAPSHOT, which need each buffer's own bookkeeping.
+ */
+#if defined(RB_WATERMARKS) || defined(RB_STATS) || defined(RB_SNAPSHOT)
+   #define RB_ERASED(T, N)       0
+#else
+   #define RB_ERASED(T, N)       (RB_LIFE(T, N) == RB_LIFE_TRIVIAL)
+#endif
+
+#define RB_GET_READ        0           //An empty buffer hands back the element at the read index, as read().
+#define RB_GET_BACK        1           //An empty buffer hands back the last one read, as p_read().
+#define RB_GET_POP         2           //An empty buffer leaves dst alone, as pop().
+
+/**
+ * Room for one element that is never default constructed, for the value paths to have ringErased copy the bytes of an
+ * element into. Only used for trivially copyable types, which the copy brings to life.
+ */
+template<typename T>
+union ringHold{
+   ringHold(){
+   }
+
+   T value;
+};
+
+template<typename I>
+struct ringErased{
+   static inline I slot(I pos, I len){
+      return (pos >= len) ? pos - len : pos;
+   }
+
+   static inline I advance(I pos, size_t n, I len){
+      I limit = (I)(2 * len - n);                 //n never exceeds len, so pos + n is never formed.
+      return (pos >= limit) ? pos - limit : (I)(pos + n);
+   }
+
+   static inline I count(I w, I r, I len){
+      return (w >= r) ? w - r : w + 2 * len - r;
+   }
+
+   static inline void copy(uint8_t *dst, uint8_t const *src, size_t size){
+      while(size--){
+         *dst++ = *src++;
+      }
+   }
+
+   /**
+    * Stores one element of size bytes from src. onFull is the policy of the call, RB_DROP for p_write(). Returns the
+    * same as write(). Each policy, like each mode below, is its own function, so only the ones a sketch calls are built.
+    */
+   template<uint8_t onFull>
+   static __attribute__((__noinline__)) I put(ringIndices<I> *pos, void *addr, I len, size_t size, void const *src){
+      I w = pos->writePos;
+      I r = ringLoad(pos->readPos);
+
+      while(__builtin_expect(count(w, r, len) == len, 0)){
+         if(onFull == RB_OVERWRITE){
+            r = advance(r, 1, len);
+            ringStore(pos->readPos, r);         //Drops the oldest value to make room.
+         }else if(onFull == RB_BLOCK){
+            RB_YIELD();
+            r = ringLoad(pos->readPos);
+         }else{
+            return (onFull == RB_ERROR) ? (I)~(I)0 : slot(w, len);
+         }
+      }
+
+      copy((uint8_t *)addr + (size_t)slot(w, len) * size, (uint8_t const *)src, size);
+      w = advance(w, 1, len);
+      RB_BARRIER();                             //The element has to land before the consumer can see the new index.
+      ringStore(pos->writePos, w);
+      return slot(w, len);
+   }
+
+   /**
+    * Moves the oldest element into dst. Returns 0 when the buffer is empty, handing back what mode says.
+    */
+   template<uint8_t mode>
+   static __attribute__((__noinline__)) uint8_t get(ringIndices<I> *pos, void const *addr, I len, size_t size,
+                                                   void *dst){
+      I r = pos->readPos;
+      I index = slot(r, len);
+
+      if(__builtin_expect(r == ringLoad(pos->writePos), 0)){
+         if(mode == RB_GET_BACK){
+            index = (index == 0 ? len : index) - 1;
+         }
+         if(mode != RB_GET_POP){
+            copy((uint8_t *)dst, (uint8_t const *)addr + (size_t)index * size, size);
+         }
+         return 0;
+      }
+
+      if(mode != RB_GET_READ){                  //read() is not meant to race a producer, so it skips the fences.
+         RB_BARRIER();                          //Read the element only after seeing the producer's index.
+      }
+      copy((uint8_t *)dst, (uint8_t const *)addr + (size_t)index * size, size);
+      if(mode != RB_GET_READ){
+         RB_BARRIER();                          //The element has to be copied out before the slot is handed back.
+      }
+      ringStore(pos->readPos, advance(r, 1, len));
+      return 1;
+   }
+
+   /**
+    * Moves the read index past the oldest element and returns its slot, for the pointer API. When the buffer is empty,
+    * leaves the index alone and returns the slot mode says.
+    */
+   template<uint8_t mode>
+   static __attribute__((__noinline__)) I take(ringIndices<I> *pos, I len){
+      I r = pos->readPos;
+      I index = slot(r, len);
+
+      if(__builtin_expect(r == ringLoad(pos->writePos), 0)){
+         return (mode == RB_GET_BACK) ? (index == 0 ? len : index) - 1 : index;
+      }
+
+      if(mode != RB_GET_READ){
+         RB_BARRIER();                          //The slot is handed out only after seeing the producer's index.
+      }
+      ringStore(pos->readPos, advance(r, 1, len));
+      return index;
+   }
+
+   /**
+    * Copies up to n elements in from src, or out to dst when in is 0, in at most two blocks. Returns the number moved.
+    */
+   template<uint8_t in>
+   static __attribute__((__noinline__)) size_t move(ringIndices<I> *pos, void *addr, I len, size_t size, void *buf,
+                                                   size_t n){
+      I w = in ? pos->writePos : ringLoad(pos->writePos);
+      I r = in ? ringLoad(pos->readPos) : pos->readPos;
+      I at = in ? w : r;
+      size_t avail = in ? len - count(w, r, len) : count(w, r, len);
+
+      if(n > avail){
+         n = avail;
+      }
+
+      size_t index = slot(at, len);
+      size_t part = len - index;                //How many elements fit before the end of the array.
+      if(part > n){
+         part = n;
+      }
+
+      uint8_t *ring = (uint8_t *)addr;
+      uint8_t *user = (uint8_t *)buf;
+      RB_BARRIER();                             //Move the elements only after seeing the other side's index.
+      ringCopy(in ? ring + index * size : user, in ? user : ring + index * size, part * size);
+      ringCopy(in ? ring : user + part * size, in ? user + part * size : ring, (n - part) * size);
+      RB_BARRIER();                             //The elements have to be moved before the index hands them over.
+      ringStore(in ? pos->writePos : pos->readPos, advance(at, n, len));
+      return n;
+   }
+};
+#endif
+
+#if defined(RB_WATERMARKS)
+/**
+ * Watermark state of a RingBuffer, only present when RB_WATERMARKS is defined before including this header.
+ */
+template<typename I>
+struct ringMarks{
+   volatile I highPos;                 //The write index at which the buffer holds `high` elements. Stored by whichever side moves readPos.
+   I high;                             //Occupancy that raises highHit. 0 turns it off.
+   I low;                              //Occupancy that raises lowHit. Set to writeError to turn it off.
+   void (*onHigh)();                   //Called by the writer when the buffer fills up to the high mark.
+   void (*onLow)();                    //Called by the reader when the buffer drains down to the low mark.
+   volatile uint8_t highHit;           //Set by the writer, cleared by reachedHigh().
+   volatile uint8_t lowHit;            //Set by the reader, cleared by reachedLow().
+};
+#endif
+
+#if defined(RB_STATS)
+/**
+ * Usage counters of a RingBuffer, only present when RB_STATS is defined before including this header. Each field is
+ * only updated by one side, so the writer and reader never share a counter.
+ */
+template<typename I>
+struct ringStats{
+   I maxUsed;                          //The most elements the buffer has held at once. Updated by the writer.
+   uint32_t dropped;                   //Values a write dropped, refused or overwrote. Updated by the writer.
+   uint32_t emptyReads;                //Reads that found the buffer empty. Updated by the reader.
+   uint32_t moved;                     //Elements written into the buffer. Updated by the writer.
+};
+#endif
+
+/**
+ * Backing storage for a RingBuffer. When the capacity is known at compile time the array lives inside the object,
+ * otherwise it points at an array handed over by the user and keeps the length alongside it. An array inside the
+ * object is never default constructed, so element types don't need a default constructor.
+ */
+template<typename T, size_t N, typename I, uint8_t life = RB_LIFE(T, N)>
+struct ringStorage : ringIndices<I>{
+   union{
+      T addr[N];                       //The array of the type which will be stored, held inside the object.
+   };
+
+   ringStorage(){
+   }
+
+   inline I length() const{
+      return N;
+   }
+};
+
+/**
+ * Storage held inside the object for types that are not trivially copyable. Like the storage above, sitting in a
+ * union keeps the array from being default constructed, and the elements still in the buffer are destroyed along
+ * with it.
+ */
+template<typename T, size_t N, typename I>
+struct ringStorage<T, N, I, RB_LIFE_RAW> : ringIndices<I>{
+   union{
+      T addr[N];                       //The array of the type which will be stored, constructed one element at a time.
+   };
+
+   ringStorage(){
+   }
+
+   ~ringStorage(){
+      for(I i = this->readPos; i != this->writePos; i = (i + 1) % (2 * N)){
+         addr[i % N].~T();
+      }
+   }
+
+   inline I length() const{
+      return N;
+   }
+};
+
+template<typename T, typename I, uint8_t life>
+struct ringStorage<T, 0, I, life> : ringIndices<I>{
+   T *addr;                            //A pointer for an array of the type which will be stored.
+   I arrLen;                           //How many elements long this RingBuffer will be.
+
+   inline I length() const{
+      return arrLen;
+   }
+};
+
+/**
+ * Shared state for both RingBuffer specializations. Holds the storage and indices, and provides the index wrapping
+ * used by every read and write path.
+ * 
+ * The read and write indices run over twice the length of the buffer, and are folded back onto the array when an
+ * element is accessed. This lets full and empty be told apart from the two indices alone, without a shared flag byte.
+ * The writer only ever stores writePos and the reader only ever stores readPos, so a single producer and a single
+ * consumer (such as an ISR and loop()) can use p_write() and p_read() without a critical section.
+ * 
+ * When N is a power of two, wrapping is done with a single AND against a mask. For any other N, or for capacities only
+ * known at runtime (N = 0), wrapping is done with a compare-and-reset. Neither form needs a division, which on 8-bit
+ * AVR would otherwise be a call to __udivmodqi4.
+ */
+template<typename T, size_t N, typename P, typename I>
+class RingBufferCore{
+   typedef ringWrap<N, I> wrap;        //The wrapping for a compile-time capacity.
+   static_assert(sizeof(wrap) != 0, "Instantiates ringWrap, which checks the indices hold twice the capacity.");
+
+   public:
+      /**
+       * The value write() returns under the ReturnError policy when the buffer is full. Never a valid index.
+       */
+      static const I writeError = (I)~(I)0;
+
+      /**
+       * The largest capacity a runtime sized buffer can have: indices run over twice the capacity, so half the range of
+       * the index type. 32767 elements with the 16 bit indices AVR uses by default, 127 with uint8_t indices.
+       */
+      static const I maxLength = (I)((I)~(I)0 / 2);
+
+      /**
+       * Writes up to n values from src to the RingBuffer, with protection. Never overwrites unread data, and returns
+       * the number of elements that were actually stored.
+       * 
+       * The free space is copied in at most two blocks, one up to the end of the array and one from its start, and
+       * the write index is only advanced once. Follows the same single producer rules as p_write().
+       */
+      size_t write(T const *src, size_t n){
+         ringBuff *b = &buff;
+#if defined(RB_OPTIMIZE_SIZE)
+         if(RB_ERASED(T, N)){
+            return ringErased<I>::template move<1>(b, b->addr, b->length(), sizeof(T), (void *)src, n);
+         }
+#endif
+         I w = b->writePos;
+         I space = b->length() - count(w, load(b->readPos));
+
+         if(n > space){
+            markDrop(n - space);
+            n = space;
+         }
+
+         I index = slot(w);
+         I part = b->length() - index;          //How many elements fit before the end of the array.
+         if(part > n){
+            part = n;
+         }
+
+         life::copyIn(&b->addr[index], src, part);
+         life::copyIn(&b->addr[0], src + part, n - part);
+         RB_BARRIER();                          //The elements have to land before the consumer can see the new index.
+         store(b->writePos, advance(w, n));
+         markWrite(b->length() - space, n);
+
+         return n;
+      }
+
+      /**
+       * Reads up to n values from the RingBuffer into dst, with protection. Never reads past the write index, and
+       * returns the number of elements that were actually read.
+       * 
+       * The data is copied out in at most two blocks, and the read index is only advanced once. Follows the same single
+       * consumer rules as p_read().
+       */
+      size_t read(T *dst, size_t n){
+         ringBuff *b = &buff;
+#if defined(RB_OPTIMIZE_SIZE)
+         if(RB_ERASED(T, N)){
+            return ringErased<I>::template move<0>(b, b->addr, b->length(), sizeof(T), dst, n);
+         }
+#endif
+         I r = b->readPos;
+         I avail = count(load(b->writePos), r);
+
+         if(n > avail){
+            if(avail == 0){
+               markEmpty();
+            }
+            n = avail;
+         }
+
+         I index = slot(r);
+         I part = b->length() - index;
+         if(part > n){
+            part = n;
+         }
+
+         RB_BARRIER();                          //Read the elements only after seeing the producer's index.
+         life::copyOut(dst, &b->addr[index], part);
+         life::copyOut(dst + part, &b->addr[0], n - part);
+         RB_BARRIER();                          //The elements have to be copied out before the slots are handed back.
+         store(b->readPos, advance(r, n));
+         markRead(advance(r, n), avail, n);
+
+         return n;
+      }
+
+      /**
+       * Reads up to n values into dst the same way as read(dst, n), passing each one through convert on its way out,
+       * such as ringGain to turn int16_t samples into scaled floats. The conversion happens in the copy itself, so the
+       * data is only gone over once. convert is called as convert(element) and its result stored into dst.
+       */
+      template<typename D, typename F>
+      size_t read(D *dst, size_t n, F convert){
+         ringBuff *b = &buff;
+         I r = b->readPos;
+         I avail = count(load(b->writePos), r);
+
+         if(n > avail){
+            if(avail == 0){
+               markEmpty();
+            }
+            n = avail;
+         }
+
+         I index = slot(r);
+         I part = b->length() - index;
+         if(part > n){
+            part = n;
+         }
+
+         RB_BARRIER();                          //Read the elements only after seeing the producer's index.
+         T *src = &b->addr[index];
+         for(I i = 0; i < part; i++){
+            *dst++ = convert(*src);
+            life::drop(src++);
+         }
+         src = &b->addr[0];                     //The rest continues from the start of the array.
+         for(I i = part; i < n; i++){
+            *dst++ = convert(*src);
+            life::drop(src++);
+         }
+         RB_BARRIER();                          //The elements have to be converted before the slots are handed back.
+         store(b->readPos, advance(r, n));
+         markRead(advance(r, n), avail, n);
+
+         return n;
+      }
+
+#if defined(RB_SNAPSHOT)
+      /**
+       * Copies the newest n unread elements into dst, oldest first, without reading them, while the producer keeps
+       * writing, such as to capture the samples leading up to a fault from an OverwriteOldest ring fed by an ISR.
+       * Returns the number of elements copied, which is less than n when fewer are unread, and is at most one less
+       * than the capacity, as the slot the writer fills next holds the oldest element.
+       *
+       * Interrupts are never held off. The writer counts every element it stores, and the count and write index are
+       * read before and after the copy: when the writer got far enough in between to reach the copied slots, the copy
+       * is taken again. Only present when RB_SNAPSHOT is defined before including this header.
+       */
+      size_t snapshotLatest(T *dst, size_t n) const{
+         static_assert(__is_trivially_copyable(T), "snapshotLatest() copies elements the writer may be replacing.");
+         ringBuff const *b = &buff;
+         I len = b->length();
+
+         for(;;){
+            size_t before = ringLoad(seq);
+            I w = load(b->writePos);
+            I avail = count(w, load(b->readPos));
+            I k = (avail < len) ? avail : len - 1;
+            if(n < k){
+               k = n;
+            }
+
+            I index = slot(w);
+            I start = (index >= k) ? index - k : index + len - k;
+            I part = len - start;
+            if(part > k){
+               part = k;
+            }
+
+            RB_BARRIER();                       //Copy the elements only after seeing the producer's index.
+            ringCopy(dst, &b->addr[start], part * sizeof(T));
+            ringCopy(dst + part, &b->addr[0], (k - part) * sizeof(T));
+            RB_BARRIER();                       //The copy has to be done before checking how far the writer got.
+
+            size_t moved = ringLoad(seq) - before;
+            if(__builtin_expect(count(load(b->writePos), w) + k < len && moved + k < len, 1)){
+               return k;
+            }
+         }
+      }
+#endif
+
+      /**
+       * A contiguous block of elements inside the RingBuffer's array.
+       */
+      struct span{
+         T *addr;                               //The first element of the block.
+         I length;                              //How many elements are in the block.
+      };
+
+      /**
+       * Borrows up to n free elements for writing in place, such as the target of a DMA transfer. The block never
+       * wraps, so it may be shorter than n even when there is more free space; its length is 0 when the buffer is full.
+       * 
+       * Nothing becomes readable until commit() is called. Follows the same single producer rules as p_write().
+       */
+      span reserve(I n){
+         static_assert(RB_LIFE(T, N) != RB_LIFE_RAW, "reserve() would lend out unconstructed elements, use emplace().");
+         ringBuff *b = &buff;
+         I w = b->writePos;
+         I space = b->length() - count(w, load(b->readPos));
+         I index = slot(w);
+         span s = {&b->addr[index], (I)(b->length() - index)};
+
+         if(s.length > space){
+            s.length = space;
+         }
+         if(s.length > n){
+            s.length = n;
+         }
+
+         return s;
+      }
+
+      /**
+       * Hands the first n elements of the block returned by reserve() over to the reader. n is limited to the free
+       * space left in the buffer.
+       */
+      void commit(I n){
+         ringBuff *b = &buff;
+         I w = b->writePos;
+         I space = b->length() - count(w, load(b->readPos));
+
+         if(n > space){
+            n = space;
+         }
+
+         RB_BARRIER();                          //The elements have to land before the consumer can see the new index.
+         store(b->writePos, advance(w, n));
+         markWrite(b->length() - space, n);
+      }
+
+      /**
+       * Borrows the largest block of unread elements that can be read in place, such as the source of a DMA
+       * transfer. The block never wraps, so once it has been consumed another call may return the rest of the data;
+       * its length is 0 when the buffer is empty.
+       * 
+       * The elements stay in the buffer until consume() is called. Follows the same single consumer rules as p_read().
+       */
+      span peek(){
+         ringBuff *b = &buff;
+         I r = b->readPos;
+         I avail = count(load(b->writePos), r);
+         I index = slot(r);
+         span s = {&b->addr[index], (I)(b->length() - index)};
+
+         if(s.length > avail){
+            s.length = avail;
+         }
+
+         RB_BARRIER();                          //Read the elements only after seeing the producer's index.
+         return s;
+      }
+
+      /**
+       * Releases the first n elements of the block returned by peek() back to the writer. n is limited to the number
+       * of unread elements in the buffer.
+       */
+      void consume(I n){
+         ringBuff *b = &buff;
+         I r = b->readPos;
+         I avail = count(load(b->writePos), r);
+
+         if(n > avail){
+            n = avail;
+         }
+
+         RB_BARRIER();                          //The elements have to be used before the slots are handed back.
+         if(RB_LIFE(T, N) == RB_LIFE_RAW){
+            for(I i = 0; i < n; i++){
+               life::drop(&b->addr[slot(advance(r, i))]);
+            }
+         }
+         store(b->readPos, advance(r, n));
+         markRead(advance(r, n), avail, n);
+      }
+
+      /**
+       * Moves a value into the RingBuffer. Follows the overflow policy and returns the same as write(), but moves the
+       * value instead of copying it.
+       */
+      inline I push(T &&data){
+         return emplace(ringMove(data));
+      }
+
+      /**
+       * Constructs a new value in the RingBuffer from the passed arguments. When the array is stored inside the
+       * object, the value is built directly in its slot, skipping both the default construction and the copy.
+       * Follows the overflow policy and returns the same as write().
+       */
+      template<typename... A>
+      RB_PATH I emplace(A&&... args){
+         ringBuff *b = &buff;
+         I w = b->writePos;
+
+         if(__builtin_expect(!room(w), 0)){
+            return refused(w);
+         }
+
+         life::make(&b->addr[slot(w)], ringForward<A>(args)...);
+         w = next(w);
+         RB_BARRIER();                          //The element has to land before the consumer can see the new index.
+         store(b->writePos, w);
+         markWrite(w);
+
+         return slot(w);
+      }
+
+      /**
+       * Moves the oldest value out of the RingBuffer into dst, destroying what is left in the slot. Returns 0, leaving
+       * dst untouched, when the buffer is empty. Follows the same single consumer rules as p_read().
+       */
+      RB_PATH uint8_t pop(T &dst){
+         ringBuff *b = &buff;
+#if defined(RB_OPTIMIZE_SIZE)
+         if(RB_ERASED(T, N)){
+            return ringErased<I>::template get<RB_GET_POP>(b, b->addr, b->length(), sizeof(T), &dst);
+         }
+#endif
+         I r = b->readPos;
 
-#define CLEAR_BITMASK(x, y)    (x &= (~y))
-#define SET_BITMASK(x, y)      (x |= (y))
-#define CHECK_BITMASK(x, y)    (x & (y))
+         if(__builtin_expect(r == load(b->writePos), 0)){
+            markEmpty();
+            return 0;
+         }
+
+         RB_BARRIER();                          //Read the element only after seeing the producer's index.
+         T *item = &b->addr[slot(r)];
+         dst = ringMove(*item);
+         life::drop(item);
+         RB_BARRIER();                          //The element has to be moved out before the slot is handed back.
+         store(b->readPos, next(r));
+         markRead(next(r));
+
+         return 1;
+      }
+
+#if defined(RB_WATERMARKS)
+      /**
+       * Sets the watermarks. high is reached when a write brings the buffer up to that many elements, and low when a
+       * read brings it down to that many, so a consumer can sleep until a batch is waiting and drain it with
+       * read(dst, n). A high of 0 or a low of writeError turns that mark off.
+       * 
+       * onHigh runs in the writer's context, which may be an ISR, and onLow in the reader's; keep both short. Call
+       * from the reader, or before the buffer is in use. A mark can be reached one element early or late when it races
+       * an index update from the other side.
+       */
+      void setWatermarks(I high, I low = writeError, void (*onHigh)() = 0, void (*onLow)() = 0){
+         marks.high = high;
+         marks.low = low;
+         marks.onHigh = onHigh;
+         marks.onLow = onLow;
+         rearm(buff.readPos);
+      }
+
+      /**
+       * Returns 1 if the high watermark was reached since the last call, clearing the flag.
+       */
+      inline uint8_t reachedHigh(){
+         uint8_t hit = marks.highHit;
+         marks.highHit = 0;
+         return hit;
+      }
+
+      /**
+       * Returns 1 if the low watermark was reached since the last call, clearing the flag.
+       */
+      inline uint8_t reachedLow(){
+         uint8_t hit = marks.lowHit;
+         marks.lowHit = 0;
+         return hit;
+      }
+#endif
+
+#if defined(RB_STATS)
+      /**
+       * Returns a copy of the usage counters, such as to print over Serial when sizing a buffer. Taken field by field,
+       * so a counter may be one update behind the others when the other side is running.
+       */
+      inline ringStats<I> stats() const{
+         ringStats<I> copy = counts;
+         return copy;
+      }
+
+      /**
+       * Zeroes the usage counters.
+       */
+      void resetStats(){
+         counts.maxUsed = 0;
+         counts.dropped = 0;
+         counts.emptyReads = 0;
+         counts.moved = 0;
+      }
+#endif
+
+      /**
+       * Returns the number of unread elements. Loads both indices, so the producer can call it too.
+       */
+      inline I size() const{
+         return count(load(buff.writePos), load(buff.readPos));
+      }
+
+      /**
+       * Returns the unread element i places after the read index, without reading it; 0 is the element read() would
+       * return next. i must be less than size(). Follows the same single consumer rules as p_read().
+       */
+      inline T &operator[](I i){
+         return buff.addr[slot(advance(buff.readPos, i))];
+      }
+
+      inline T const &operator[](I i) const{
+         return buff.addr[slot(advance(buff.readPos, i))];
+      }
+
+      /**
+       * A forward iterator over the unread elements, from the oldest to the newest. Walks the same doubled indices
+       * as the buffer, so the iterator of a full buffer's first element is still told apart from its end.
+       */
+      template<typename E, typename C>
+      class ringIter{
+         public:
+#if !defined(__AVR__)
+            typedef std::forward_iterator_tag iterator_category;
+#endif
+            typedef T value_type;
+            typedef ptrdiff_t difference_type;
+            typedef E *pointer;
+            typedef E &reference;
+
+            ringIter(C *rb, I pos) : rb(rb), pos(pos){
+            }
+
+            inline E &operator*() const{
+               return rb->buff.addr[rb->slot(pos)];
+            }
+
+            inline E *operator->() const{
+               return &rb->buff.addr[rb->slot(pos)];
+            }
+
+            inline ringIter &operator++(){
+               pos = rb->next(pos);
+               return *this;
+            }
+
+            inline ringIter operator++(int){
+               ringIter old = *this;
+               pos = rb->next(pos);
+               return old;
+            }
+
+            inline bool operator==(ringIter const &other) const{
+               return pos == other.pos;
+            }
+
+            inline bool operator!=(ringIter const &other) const{
+               return pos != other.pos;
+            }
+
+         private:
+            C *rb;
+            I pos;
+      };
+
+      typedef ringIter<T, RingBufferCore> iterator;
+      typedef ringIter<T const, RingBufferCore const> const_iterator;
+
+      /**
+       * Iterators over the unread elements, for range-for and, where the standard library is available, <algorithm>.
+       * Nothing is read: the elements stay in the buffer. end() is taken from the write index when it is called, so
+       * elements the producer adds later are left out. Follows the same single consumer rules as p_read().
+       */
+      inline iterator begin(){
+         return iterator(this, buff.readPos);
+      }
+
+      inline iterator end(){
+         return iterator(this, load(buff.writePos));
+      }
+
+      inline const_iterator begin() const{
+         return const_iterator(this, buff.readPos);
+      }
+
+      inline const_iterator end() const{
+         return const_iterator(this, load(buff.writePos));
+      }
+
+      /**
+       * A method that can be called to check if the ring buffer is full. This is faster than calling write() again.
+       */
+      inline uint8_t isFull() const{
+         return full(load(buff.writePos), load(buff.readPos));
+      }
+
+      /**
+       * A method that can be called to check if the ring buffer is empty. This is faster than calling read() again.
+       */
+      inline uint8_t isEmpty() const{
+         return load(buff.writePos) == load(buff.readPos);
+      }
+
+   protected:
+      /**
+       * Starts the buffer out empty.
+       */
+      RingBufferCore(){
+         buff.readPos = 0;
+         buff.writePos = 0;
+#if defined(RB_WATERMARKS)
+         marks.highPos = 0;
+         marks.high = 0;
+         marks.low = writeError;
+         marks.onHigh = 0;
+         marks.onLow = 0;
+         marks.highHit = 0;
+         marks.lowHit = 0;
+#endif
+#if defined(RB_STATS)
+         resetStats();
+#endif
+#if defined(RB_SNAPSHOT)
+         seq = 0;
+#endif
+      }
+
+      struct ringBuff : ringStorage<T, N, I>{
+      };
+      typedef ringLife<T, RB_LIFE(T, N)> life;
+      ringBuff buff;                   //The RingBuffer struct which contains all global variables.
+#if defined(RB_WATERMARKS)
+      ringMarks<I> marks;              //Watermark thresholds, hooks and flags.
+#endif
+#if defined(RB_STATS)
+      ringStats<I> counts;             //Usage counters returned by stats().
+#endif
+#if defined(RB_SNAPSHOT)
+      volatile size_t seq;             //Elements ever written, checked by snapshotLatest(). Only stored by the writer.
+#endif
+
+      /**
+       * Loads and stores of the indices shared with the other side of the buffer, see ringLoad() and ringStore().
+       */
+      static inline I load(volatile I const &pos){
+         return ringLoad(pos);
+      }
+
+      static inline void store(volatile I &pos, I value){
+         ringStore(pos, value);
+      }
+
+      /**
+       * Returns the index following pos, wrapped to twice the bounds of the buffer.
+       */
+      inline I next(I pos) const{
+         if(N != 0){
+            return wrap::next(pos);             //A single AND when N is a power of two.
+         }
+
+         pos++;
+         return (pos == 2 * buff.length()) ? 0 : pos;
+      }
+
+      /**
+       * Folds an index back onto the array, returning the element it refers to.
+       */
+      inline I slot(I pos) const{
+         if(N != 0){
+            return wrap::slot(pos);
+         }
+
+         return (pos >= buff.length()) ? pos - buff.length() : pos;
+      }
+
+      /**
+       * Returns the index n places after pos, wrapped to twice the bounds of the buffer. n must not be more than the
+       * length of the buffer.
+       */
+      inline I advance(I pos, I n) const{
+         if(N != 0){
+            return wrap::advance(pos, n);
+         }
+
+         I limit = 2 * buff.length() - n;       //Compared against pos instead of pos + n, which could overflow the index.
+         return (pos >= limit) ? pos - limit : pos + n;
+      }
+
+      /**
+       * Applies the overflow policy before writing at index w. Returns 0 when the new value should not be stored.
+       * Only the branch for the selected policy is compiled in. Every policy other than OverwriteOldest leaves the
+       * read index to the reader, keeping write() safe for a single producer and consumer.
+       */
+      inline uint8_t room(I w){
+         I r = load(buff.readPos);
+
+         if(__builtin_expect(!full(w, r), 1)){
+            return 1;
+         }
+
+         if(P::onFull == RB_OVERWRITE){
+            life::drop(&buff.addr[slot(r)]);
+            store(buff.readPos, next(r));       //Drops the oldest value to make room.
+            markDrop(1);
+            rearm(next(r));
+            return 1;
+         }
+
+         if(P::onFull == RB_BLOCK){
+            while(full(w, load(buff.readPos))){
+               RB_YIELD();
+            }
+            return 1;
+         }
+
+         return 0;
+      }
+
+      /**
+       * Bookkeeping after a single write moved the write index to w. Checks the high watermark, which the reader keeps
+       * as the write index where the buffer holds `high` elements, so it takes one compare instead of working out the
+       * occupancy. Compiles to nothing without RB_WATERMARKS, RB_STATS or RB_SNAPSHOT.
+       */
+      inline void markWrite(I w){
+         (void)w;
+#if defined(RB_WATERMARKS)
+         if(__builtin_expect(w == load(marks.highPos), 0)){
+            marks.highHit = 1;
+            if(marks.onHigh){
+               marks.onHigh();
+            }
+         }
+#endif
+#if defined(RB_STATS)
+         I used = count(w, load(buff.readPos));
+         if(used > counts.maxUsed){
+            counts.maxUsed = used;
+         }
+         counts.moved++;
+#endif
+#if defined(RB_SNAPSHOT)
+         ringStore(seq, (size_t)(seq + 1));
+#endif
+      }
+
+      /**
+       * Bookkeeping after n elements were written on top of the `before` already stored.
+       */
+      inline void markWrite(I before, I n){
+         (void)before; (void)n;
+#if defined(RB_WATERMARKS)
+         if(before < marks.high && before + n >= marks.high){
+            marks.highHit = 1;
+            if(marks.onHigh){
+               marks.onHigh();
+            }
+         }
+#endif
+#if defined(RB_STATS)
+         if((I)(before + n) > counts.maxUsed){
+            counts.maxUsed = before + n;
+         }
+         counts.moved += n;
+#endif
+#if defined(RB_SNAPSHOT)
+         ringStore(seq, (size_t)(seq + n));
+#endif
+      }
+
+      /**
+       * Counts n values that a write dropped or overwrote.
+       */
+      inline void markDrop(size_t n){
+         (void)n;
+#if defined(RB_STATS)
+         counts.dropped += n;
+#endif
+      }
+
+      /**
+       * Counts a read that found the buffer empty.
+       */
+      inline void markEmpty(){
+#if defined(RB_STATS)
+         counts.emptyReads++;
+#endif
+      }
+
+      /**
+       * Moves highPos along with a read index that was just stored. Called by whichever side moved readPos.
+       */
+      inline void rearm(I r){
+         (void)r;
+#if defined(RB_WATERMARKS)
+         store(marks.highPos, advance(r, marks.high));
+#endif
+      }
+
+      /**
+       * Checks the low watermark after a single read moved the read index to r.
+       */
+      inline void markRead(I r){
+         (void)r;
+#if defined(RB_WATERMARKS)
+         rearm(r);
+         if(__builtin_expect(count(load(buff.writePos), r) == marks.low, 0)){
+            marks.lowHit = 1;
+            if(marks.onLow){
+               marks.onLow();
+            }
+         }
+#endif
+      }
+
+      /**
+       * Checks the low watermark after n elements were read out of the `before` that were stored.
+       */
+      inline void markRead(I r, I before, I n){
+         (void)r; (void)before; (void)n;
+#if defined(RB_WATERMARKS)
+         rearm(r);
+         if(before > marks.low && before - n <= marks.low){
+            marks.lowHit = 1;
+            if(marks.onLow){
+               marks.onLow();
+            }
+         }
+#endif
+      }
 
-#define FLAG_FULL    0x01
-#define FLAG_EMPTY   0x02
+      /**
+       * Returns what write() gives back when the policy refused the value.
+       */
+      inline I refused(I w){
+         markDrop(1);
+         return (P::onFull == RB_ERROR) ? writeError : slot(w);
+      }
+
+      /**
+       * Checks if a write and read index describe a full buffer. For a power of two capacity the indices of a full
+       * buffer differ only in the bit above the mask, so this is a single XOR and compare. Empty is simply w == r.
+       */
+      inline uint8_t full(I w, I r) const{
+         if(N != 0){
+            return wrap::full(w, r);
+         }
+
+         return count(w, r) == buff.length();
+      }
+
+      /**
+       * Returns the number of elements stored between a read and write index.
+       */
+      inline I count(I w, I r) const{
+         if(N != 0){
+            return wrap::count(w, r);
+         }
+
+         return (w >= r) ? w - r : w + 2 * buff.length() - r;
+      }
+};
 
 /**
  * A general-purpose RingBuffer. Through the use of templates, allows specialized types. Also specializes said template
  * based on the size of the variable. Returns the raw value if the amount of bytes used by the type is less than or 
  * equal to that of a pointer.
+ * 
+ * The third template argument sets the capacity at compile time. When given, the array is stored inside the object and
+ * the default constructor is used. When left at 0, the capacity is set at runtime by the array passed to the
+ * constructor.
+ * 
+ * The fourth template argument is the overflow policy used by write() when the buffer is full, see OverwriteOldest,
+ * DropNewest, ReturnError and Block. The fifth is the index type, which is picked from the capacity by default.
  */
-template<typename T, uint8_t value = (sizeof(T) <= 2)>
-class RingBuffer{
+template<typename T, uint8_t value = (sizeof(T) <= 2), size_t N = 0, typename P = OverwriteOldest,
+         typename I = typename ringIndex<N>::type>
+class RingBuffer : public RingBufferCore<T, N, P, I>{
+   typedef typename RingBufferCore<T, N, P, I>::ringBuff ringBuff;
+   typedef typename RingBufferCore<T, N, P, I>::life life;
+
    public:
+      using RingBufferCore<T, N, P, I>::write;
+      using RingBufferCore<T, N, P, I>::read;
+
+      /**
+       * Construct a new Ring Buffer object with its array stored inside the object. Requires a capacity to be given
+       * as the third template argument.
+       */
+      RingBuffer(){
+         static_assert(N != 0, "RingBuffer without a compile-time capacity needs an array and element count.");
+      };
+
       /**
        * Construct a new Ring Buffer object. Uses the passed array as the ring buffer. Avoid using the array outside of
-       * this object to prevent the indexes from desyncing.
+       * this object to prevent the indexes from desyncing. Holds up to maxLength elements; a longer array is only used
+       * up to that length. Passing uint8_t as the index type gives the faster single byte indices, for arrays of up to
+       * 127 elements.
        */
-      RingBuffer(T *arr, uint8_t elements){
-         ringBuff *b = &buff;    //On AVR Architecture: Initializing Z-Pointer to our RingBuffer struct.
+      RingBuffer(T *arr, I elements){
+         static_assert(N == 0, "RingBuffer with a compile-time capacity stores its own array.");
+         ringBuff *b = &this->buff;    //On AVR Architecture: Initializing Z-Pointer to our RingBuffer struct.
 
-         b->addr = arr;          //Set our array address to the passed address.
-         b->arrLen = elements;   //Set the number of elements we have in the array.
+         b->addr = arr;                //Set our array address to the passed address.
+         b->arrLen = (elements > this->maxLength) ? this->maxLength : elements;   //More would overflow the indices.
       };
 
       /**
        * Writes a new value to the RingBuffer. Takes a pointer to a data location, of type T, and stores it in the
-       * array. When the buffer is full, it will override the oldest value by default. 
+       * array. When the buffer is full, the overflow policy decides what happens. By default it will override the oldest
+       * value, moving the read index past it.
        * 
-       * To change the way that a full buffer is handled, the user is expected to use their own function to determine
-       * if this method should be called or not.
+       * As the default policy can move the read index, it is not safe to call while a consumer reads from another
+       * context; use p_write() or another policy for that.
        */
-      inline uint8_t write(T const *data){
-         ringBuff *b = &buff;                //On AVR Architecture: Initializing Z-Pointer to our RingBuffer struct.
+      RB_PATH I write(T const *data){
+         ringBuff *b = &this->buff;             //On AVR Architecture: Initializing Z-Pointer to our RingBuffer struct.
+#if defined(RB_OPTIMIZE_SIZE)
+         if(RB_ERASED(T, N)){
+            return ringErased<I>::template put<P::onFull>(b, b->addr, b->length(), sizeof(T), data);
+         }
+#endif
+         I w = b->writePos;
+
+         if(__builtin_expect(!this->room(w), 0)){
+            return this->refused(w);            //Only reachable with the DropNewest or ReturnError policies.
+         }
              
-         b->addr[b->writePos++] = *data;     //Takes the data stored at the passed memory location, and stores it in the ring buffer.
-         return (b->writePos %= b->arrLen);  //Limits the bounds of the internal index, and returns the next index value.
+         life::make(&b->addr[this->slot(w)], *data);  //Takes the data stored at the passed memory location, and stores it in the ring buffer.
+         w = this->next(w);                     //Limits the bounds of the internal index.
+         RB_BARRIER();                          //The element has to land before a reader or snapshotLatest() sees the index.
+         this->store(b->writePos, w);
+         this->markWrite(w);
+         return this->slot(w);                  //Returns the next index value.
       };
 
       /**
@@ -49,44 +1616,57 @@ class RingBuffer{
        * 
        * When the buffer is full and this method is called, will return the current write index instead of the next.
        * 
-       * May not be the most optimized method, or most desired behavior. 
+       * Safe to call from a single producer while a single consumer calls p_read(), such as from an ISR. The element
+       * is stored before writePos is advanced, so the consumer never sees a partly written element.
        */
-      uint8_t p_write(T const *data){
-         ringBuff *b = &buff;
-         uint8_t ret;
-
-         if(__builtin_expect(CHECK_BITMASK(b->flags, FLAG_FULL), 0)){
-            ret = b->writePos - 1;
-            if(__builtin_expect(ret > b->arrLen, 0)){
-               ret = b->arrLen;
-            }
-         }else{
-            b->addr[b->writePos++] = *data;
-            ret = (b->writePos %= b->arrLen);
-
-            CLEAR_BITMASK(b->flags, FLAG_EMPTY);
+      RB_PATH I p_write(T const *data){
+         ringBuff *b = &this->buff;
+#if defined(RB_OPTIMIZE_SIZE)
+         if(RB_ERASED(T, N)){
+            return ringErased<I>::template put<RB_DROP>(b, b->addr, b->length(), sizeof(T), data);
+         }
+#endif
+         I w = b->writePos;
 
-            if(__builtin_expect(ret == b->readPos, 0)){
-               SET_BITMASK(b->flags, FLAG_FULL);
-            }
+         if(__builtin_expect(this->full(w, this->load(b->readPos)), 0)){
+            this->markDrop(1);
+            return this->slot(w);
          }
 
-         return ret;
+         life::make(&b->addr[this->slot(w)], *data);
+         w = this->next(w);
+         RB_BARRIER();                          //The element has to land before the consumer can see the new index.
+         this->store(b->writePos, w);
+         this->markWrite(w);
+
+         return this->slot(w);
       }
 
       /**
        * Read the next value from the ring buffer. Returns a pointer to the next item in this array. If the buffer is
-       * empty, it will return the oldest value in the array next. 
+       * empty, it will return the item at the read index again without moving past it.
        * 
        * To change the way an empty buffer is handled, the user is expected to use their own function to determine if
        * this method should be called or not. 
        */
-      inline T* read(){
-         ringBuff *b = &buff;                //On AVR Architecture: Initializing Z-Pointer to our RingBuffer struct.
+      RB_PATH T* read(){
+         static_assert(RB_BORROWABLE(T, N), "read() would hand out a destroyed element, use pop() or read(dst, n).");
+         ringBuff *b = &this->buff;             //On AVR Architecture: Initializing Z-Pointer to our RingBuffer struct.
+#if defined(RB_OPTIMIZE_SIZE)
+         if(RB_ERASED(T, N)){
+            return &b->addr[ringErased<I>::template take<RB_GET_READ>(b, b->length())];
+         }
+#endif
+         I r = b->readPos;
 
-         T* item = &b->addr[b->readPos++];   //Grabs the address value of the item at read index, then increase read index by 1.
-         b->readPos %= b->arrLen;            //Ensure the read index is within bounds.
-         return item;                        //Returns the address that we previously grabbed
+         T* item = &b->addr[this->slot(r)];     //Grabs the address value of the item at read index.
+         if(__builtin_expect(r != b->writePos, 1)){
+            this->store(b->readPos, this->next(r));   //Increase the read index by 1, within bounds.
+            this->markRead(this->next(r));
+         }else{
+            this->markEmpty();
+         }
+         return item;                           //Returns the address that we previously grabbed
       };
    
       /**
@@ -96,55 +1676,32 @@ class RingBuffer{
        * When the buffer is empty and this method is called, will return the previous item returned. This can prompt
        * the user to check if the buffer is full by looking for duplicate return values.
        * 
-       * May not be the most optimized method, or most desired behavior.
+       * Safe to call from a single consumer while a single producer calls p_write(). The returned pointer refers to a
+       * slot the producer is free to reuse, so copy the item out before the producer can fill the buffer again.
        */
-      T* p_read(){
-         ringBuff *b = &buff;
-         uint8_t index;
-         T* item;
-
-         if(__builtin_expect(CHECK_BITMASK(b->flags, FLAG_EMPTY), 0)){
-            index = b->readPos - 1;
-            if(__builtin_expect(index > b->arrLen, 0)){
-               index = b->arrLen - 1;
-            }
-         } else {
-            item = &b->addr[index++];
-            b->readPos = index % b->arrLen;
-
-            CLEAR_BITMASK(b->flags, FLAG_FULL);
-
-            if(__builtin_expect(index == b->writePos, 0)){
-               SET_BITMASK(b->flags, FLAG_EMPTY);
-            }
+      RB_PATH T* p_read(){
+         static_assert(RB_BORROWABLE(T, N), "p_read() would hand out a destroyed element, use pop() or read(dst, n).");
+         ringBuff *b = &this->buff;
+#if defined(RB_OPTIMIZE_SIZE)
+         if(RB_ERASED(T, N)){
+            return &b->addr[ringErased<I>::template take<RB_GET_BACK>(b, b->length())];
          }
+#endif
+         I r = b->readPos;
+         I index = this->slot(r);
 
-         return item;
-      }
+         if(__builtin_expect(r == this->load(b->writePos), 0)){
+            this->markEmpty();
+            return &b->addr[(index == 0 ? b->length() : index) - 1];
+         }
 
-      /**
-       * A method that can be called to check if the ring buffer is full. This is faster than calling write() again.
-       */
-      inline uint8_t isFull(){
-         return CHECK_BITMASK(buff->flags, FLAG_FULL);
-      }
+         RB_BARRIER();                          //Read the element only after seeing the producer's index.
+         T* item = &b->addr[index];
+         this->store(b->readPos, this->next(r));
+         this->markRead(this->next(r));
 
-      /**
-       * A method that can be called to check if the ring buffer is empty. This is faster than calling read() again.
-       */
-      inline uint8_t isEmpty(){
-         return CHECK_BITMASK(buff->flags, FLAG_EMPTY);
+         return item;
       }
-
-   private:
-      struct ringBuff{
-         T *addr;             //A pointer for an array of the type which will be stored.
-         uint8_t arrLen;      //How many elements long this RingBuffer will be.
-         uint8_t readPos;     //The index used for reading from the buffer.
-         uint8_t writePos;    //The index used for writing from the buffer.
-         uint8_t flags;       //A series of flags used to store information and configuration for the buffer.
-      };
-      ringBuff buff;          //The RingBuffer struct which contains all global variables. 
 };
 
 
@@ -155,32 +1712,64 @@ class RingBuffer{
  * 
  * To bypass this specialization, set the second argument for your template to be 0, enter a single argument otherwise.
  */
-template<typename T>
-class RingBuffer<T, 1>{
+template<typename T, size_t N, typename P, typename I>
+class RingBuffer<T, 1, N, P, I> : public RingBufferCore<T, N, P, I>{
+   typedef typename RingBufferCore<T, N, P, I>::ringBuff ringBuff;
+   typedef typename RingBufferCore<T, N, P, I>::life life;
+
    public:
+      using RingBufferCore<T, N, P, I>::write;
+      using RingBufferCore<T, N, P, I>::read;
+
+      /**
+       * Construct a new Ring Buffer object with its array stored inside the object. Requires a capacity to be given
+       * as the third template argument.
+       */
+      RingBuffer(){
+         static_assert(N != 0, "RingBuffer without a compile-time capacity needs an array and element count.");
+      };
+
       /**
        * Construct a new Ring Buffer object. Uses the passed array as the ring buffer. Avoid using the array outside of
-       * this object to prevent the indexes from desyncing.
+       * this object to prevent the indexes from desyncing. Holds up to maxLength elements; a longer array is only used
+       * up to that length. Passing uint8_t as the index type gives the faster single byte indices, for arrays of up to
+       * 127 elements.
        */
-      RingBuffer(T *arr, uint8_t elements){
-         ringBuff *b = &buff;             //On AVR Architecture: Initializing Z-Pointer to our RingBuffer struct.
+      RingBuffer(T *arr, I elements){
+         static_assert(N == 0, "RingBuffer with a compile-time capacity stores its own array.");
+         ringBuff *b = &this->buff;       //On AVR Architecture: Initializing Z-Pointer to our RingBuffer struct.
 
          b->addr = arr;                   //Set our array address to the passed address.
-         b->arrLen = elements;            //Set the number of elements we have in the array.
+         b->arrLen = (elements > this->maxLength) ? this->maxLength : elements;   //More would overflow the indices.
       };
 
       /**
        * Writes a new value to the RingBuffer. Takes the data directly and stores a copy of that data in the array.
-       * When the buffer is full, it will override the oldest value by default.
+       * When the buffer is full, the overflow policy decides what happens. By default it will override the oldest
+       * value, moving the read index past it.
        * 
-       * To change the way that a full buffer is handled, the user is expected to use their own function to determine
-       * if this method should be called or not.
+       * As the default policy can move the read index, it is not safe to call while a consumer reads from another
+       * context; use p_write() or another policy for that.
        */
-      inline uint8_t write(T data){
-         ringBuff *b = &buff;                   //On AVR Architecture: Initializing Z-Pointer to our RingBuffer struct.
+      RB_PATH I write(T data){
+         ringBuff *b = &this->buff;             //On AVR Architecture: Initializing Z-Pointer to our RingBuffer struct.
+#if defined(RB_OPTIMIZE_SIZE)
+         if(RB_ERASED(T, N)){
+            return ringErased<I>::template put<P::onFull>(b, b->addr, b->length(), sizeof(T), &data);
+         }
+#endif
+         I w = b->writePos;
+
+         if(__builtin_expect(!this->room(w), 0)){
+            return this->refused(w);            //Only reachable with the DropNewest or ReturnError policies.
+         }
 
-         b->addr[b->writePos++] = data;         //Sets the value of the buffer at index W_POS to the passed data value.
-         return (b->writePos %= b->arrLen);     //Returns the next usable index of the buffer.
+         life::make(&b->addr[this->slot(w)], data);   //Sets the value of the buffer at index W_POS to the passed data value.
+         w = this->next(w);                     //Limits the bounds of the internal index.
+         RB_BARRIER();                          //The element has to land before a reader or snapshotLatest() sees the index.
+         this->store(b->writePos, w);
+         this->markWrite(w);
+         return this->slot(w);                  //Returns the next usable index of the buffer.
       };
 
       /**
@@ -189,44 +1778,60 @@ class RingBuffer<T, 1>{
        * 
        * When the buffer is full and this method is called, will return the current write index instead of the next.
        * 
-       * May not be the most optimized method, or most desired behavior. 
+       * Safe to call from a single producer while a single consumer calls p_read(), such as from an ISR. The element
+       * is stored before writePos is advanced, so the consumer never sees a partly written element.
        */
-      uint8_t p_write(T const data){
-         ringBuff *b = &buff;
-         uint8_t ret;
-
-         if(__builtin_expect(CHECK_BITMASK(b->flags, FLAG_FULL), 0)){
-            ret = b->writePos - 1;
-            if(__builtin_expect(ret > b->arrLen, 0)){
-               ret = b->arrLen;
-            }
-         }else{
-            b->addr[b->writePos++] = data;
-            ret = (b->writePos %= b->arrLen);
-
-            CLEAR_BITMASK(b->flags, FLAG_EMPTY);
+      RB_PATH I p_write(T const data){
+         ringBuff *b = &this->buff;
+#if defined(RB_OPTIMIZE_SIZE)
+         if(RB_ERASED(T, N)){
+            return ringErased<I>::template put<RB_DROP>(b, b->addr, b->length(), sizeof(T), &data);
+         }
+#endif
+         I w = b->writePos;
 
-            if(__builtin_expect(ret == b->readPos, 0)){
-               SET_BITMASK(b->flags, FLAG_FULL);
-            }
+         if(__builtin_expect(this->full(w, this->load(b->readPos)), 0)){
+            this->markDrop(1);
+            return this->slot(w);
          }
 
-         return ret;
+         life::make(&b->addr[this->slot(w)], data);
+         w = this->next(w);
+         RB_BARRIER();                          //The element has to land before the consumer can see the new index.
+         this->store(b->writePos, w);
+         this->markWrite(w);
+
+         return this->slot(w);
       }
 
       /**
        * Read the next value from the ring buffer. Returns the data at the current read point in the ring buffer. If
-       * the buffer is empty, it will return the oldest value in the array.
+       * the buffer is empty, it will return the item at the read index again without moving past it.
        * 
        * To change the way an empty buffer is handled, the user is expected to use their own function to determine if
        * this method should be called or not. 
        */
-      inline T read(){
-         ringBuff *b = &buff;             //On AVR Architecture: Initializing Z-Pointer to our RingBuffer struct.
+      RB_PATH T read(){
+         static_assert(RB_BORROWABLE(T, N), "read() may return a destroyed element, use pop() or read(dst, n).");
+         ringBuff *b = &this->buff;             //On AVR Architecture: Initializing Z-Pointer to our RingBuffer struct.
+#if defined(RB_OPTIMIZE_SIZE)
+         if(RB_ERASED(T, N)){
+            ringHold<T> item;
+            ringErased<I>::template get<RB_GET_READ>(b, b->addr, b->length(), sizeof(T), &item.value);
+            return item.value;
+         }
+#endif
+         I r = b->readPos;
 
-         T item = b->addr[b->readPos++];  //Grabs the address value of the item at read index, then increase read index by 1.
-         b->readPos %= b->arrLen;         //Ensure the read index is within bounds.
-         return item;                     //Returns the address that we previously grabbed
+         T item = b->addr[this->slot(r)];       //Grabs the value of the item at read index.
+         if(__builtin_expect(r != b->writePos, 1)){
+            life::drop(&b->addr[this->slot(r)]);
+            this->store(b->readPos, this->next(r));   //Increase the read index by 1, within bounds.
+            this->markRead(this->next(r));
+         }else{
+            this->markEmpty();
+         }
+         return item;                           //Returns the address that we previously grabbed
       };
 
       /**
@@ -236,55 +1841,37 @@ class RingBuffer<T, 1>{
        * When the buffer is empty and this method is called, will return the previous item returned. This can prompt
        * the user to check if the buffer is full by looking for duplicate return values.
        * 
-       * May not be the most optimized method, or most desired behavior.
+       * Safe to call from a single consumer while a single producer calls p_write(). The item is copied out before
+       * readPos is advanced, so the producer cannot overwrite it mid-read.
        */
-      T* p_read(){
-         ringBuff *b = &buff;
-         uint8_t index;
-         T item;
-
-         if(__builtin_expect(CHECK_BITMASK(b->flags, FLAG_EMPTY), 0)){
-            index = b->readPos - 1;
-            if(__builtin_expect(index > b->arrLen, 0)){
-               index = b->arrLen - 1;
-            }
-         } else {
-            item = b->addr[index++];
-            b->readPos = index % b->arrLen;
-
-            CLEAR_BITMASK(b->flags, FLAG_FULL);
-
-            if(__builtin_expect(index == b->writePos, 0)){
-               SET_BITMASK(b->flags, FLAG_EMPTY);
-            }
+      RB_PATH T p_read(){
+         static_assert(RB_BORROWABLE(T, N), "p_read() may return a destroyed element, use pop() or read(dst, n).");
+         ringBuff *b = &this->buff;
+#if defined(RB_OPTIMIZE_SIZE)
+         if(RB_ERASED(T, N)){
+            ringHold<T> item;
+            ringErased<I>::template get<RB_GET_BACK>(b, b->addr, b->length(), sizeof(T), &item.value);
+            return item.value;
          }
+#endif
+         I r = b->readPos;
+         I index = this->slot(r);
 
-         return item;
-      }
+         if(__builtin_expect(r == this->load(b->writePos), 0)){
+            this->markEmpty();
+            return b->addr[(index == 0 ? b->length() : index) - 1];
+         }
 
-      /**
-       * A method that can be called to check if the ring buffer is full. This is faster than calling write() again.
-       */
-      inline uint8_t isFull(){
-         return CHECK_BITMASK(buff->flags, FLAG_FULL);
-      }
+         RB_BARRIER();                          //Read the element only after seeing the producer's index.
+         T item = b->addr[index];
+         life::drop(&b->addr[index]);
+         RB_BARRIER();                          //The element has to be copied out before the slot is handed back.
+         this->store(b->readPos, this->next(r));
+         this->markRead(this->next(r));
 
-      /**
-       * A method that can be called to check if the ring buffer is empty. This is faster than calling read() again.
-       */
-      inline uint8_t isEmpty(){
-         return CHECK_BITMASK(buff->flags, FLAG_EMPTY);
+         return item;
       }
 
-   private:
-      struct ringBuff{
-         T *addr;
-         uint8_t arrLen;
-         uint8_t readPos;
-         uint8_t writePos;
-         uint8_t flags;
-      };
-      ringBuff buff;
 };
 
 #endif
\ No newline at end of file
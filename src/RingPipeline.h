@@ -0,0 +1,210 @@
+#ifndef RING_PIPELINE_H
+#define RING_PIPELINE_H
+
+#include "RingBuffer.h"
+
+/**
+ * Counters kept by every pipeline stage. A stage whose backlog keeps growing is the bottleneck; one that keeps
+ * stalling is waiting on the stage after it.
+ */
+struct ringStageStats{
+   uint32_t batches;                   //Runs that moved data.
+   uint32_t moved;                     //Input elements taken out of the input ring.
+   uint32_t stalls;                    //Runs that had input waiting but made no progress, such as on a full output.
+   size_t maxBacklog;                  //The most input elements found waiting at the start of a run.
+};
+
+/**
+ * Converts to the largest value of whatever unsigned type it is passed as, such as the length a ring's reserve()
+ * takes: I for a RingBuffer, size_t for a MirrorRingBuffer.
+ */
+struct ringNoLimit{
+   template<typename I>
+   inline operator I() const{
+      return (I)~(I)0;
+   }
+};
+
+/**
+ * The shared part of every stage: its input ring, its batch limit and its counters.
+ */
+template<typename A>
+class ringStageBase{
+   public:
+      /**
+       * Returns a copy of the stage's counters.
+       */
+      inline ringStageStats stats() const{
+         return counts;
+      }
+
+      /**
+       * Zeroes the stage's counters.
+       */
+      void resetStats(){
+         counts.batches = 0;
+         counts.moved = 0;
+         counts.stalls = 0;
+         counts.maxBacklog = 0;
+      }
+
+   protected:
+      ringStageBase(A &input, size_t maxBatch) : in(input){
+         batch = maxBatch;
+         resetStats();
+      }
+
+      /**
+       * Borrows the next batch of input, updating the backlog. Its length is 0 when there is nothing to do.
+       */
+      inline typename A::span next(){
+         typename A::span s = in.peek();
+         size_t backlog = in.size();
+
+         if(backlog > counts.maxBacklog){
+            counts.maxBacklog = backlog;
+         }
+         if(batch && s.length > batch){
+            s.length = batch;
+         }
+         return s;
+      }
+
+      /**
+       * Releases the used input and counts the run.
+       */
+      inline size_t done(size_t used){
+         if(used == 0){
+            counts.stalls++;
+            return 0;
+         }
+
+         in.consume(used);
+         counts.batches++;
+         counts.moved += used;
+         return used;
+      }
+
+      A &in;                           //The ring the stage reads from.
+      size_t batch;                    //The most input elements taken per run, 0 for no limit.
+      ringStageStats counts;           //Returned by stats().
+};
+
+/**
+ * A pipeline stage between two rings, such as a filter between an ADC ring filled by an ISR and a ring of packets on
+ * their way to a radio. Each run borrows a batch of input with peek() and a block of output space with reserve(),
+ * calls work on both, then commits what it made and consumes what it used: the elements are handled in place, and
+ * the per element cost of the ring is paid once per batch.
+ *
+ * work is called as work(src, n, dst, room, made): it reads up to n elements from src, writes up to room elements to
+ * dst and sets made to how many it wrote, then returns how many input elements it used. It may use fewer than n, such
+ * as a packetizer that only takes whole packets.
+ *
+ * The output is asked for reserve(ringNoLimit()), the largest length its reserve() takes, so any ring with reserve(),
+ * commit() and a span works as an output, a MirrorRingBuffer among them.
+ *
+ * Backpressure needs nothing extra: when the output ring is full the stage stalls and leaves its input alone, so its
+ * input fills up in turn, back to the first producer. The stage is the only consumer of its input and the only
+ * producer of its output, so the stages of a pipeline can run in different tasks, or all from loop() with ringRun().
+ */
+template<typename A, typename B, typename F>
+class RingStage : public ringStageBase<A>{
+   public:
+      RingStage(A &input, B &output, F work, size_t maxBatch = 0) : ringStageBase<A>(input, maxBatch), out(output),
+                                                                    func(work){
+      };
+
+      /**
+       * Moves one batch through the stage. Returns the number of input elements used, 0 when there was nothing to do
+       * or no room to do it in.
+       */
+      size_t run(){
+         typename A::span s = this->next();
+
+         if(s.length == 0){
+            return 0;
+         }
+
+         typename B::span d = out.reserve(ringNoLimit());   //As much contiguous space as there is.
+         size_t made = 0;
+         size_t used = 0;
+
+         if(d.length){
+            used = func(s.addr, (size_t)s.length, d.addr, (size_t)d.length, made);
+            if(made > d.length){
+               made = d.length;
+            }
+            if(used > s.length){
+               used = s.length;
+            }
+            out.commit(made);
+         }
+
+         return this->done(used);
+      }
+
+   private:
+      B &out;                          //The ring the stage writes to.
+      F func;                          //The work done on every batch.
+};
+
+/**
+ * The last stage of a pipeline, which hands its input to something other than a ring, such as a radio or an SD card.
+ * work is called as work(src, n) and returns how many of the n elements it used; returning 0 (such as while the radio
+ * is busy) stalls the stage, and the backpressure travels up the chain from there.
+ */
+template<typename A, typename F>
+class RingSink : public ringStageBase<A>{
+   public:
+      RingSink(A &input, F work, size_t maxBatch = 0) : ringStageBase<A>(input, maxBatch), func(work){
+      };
+
+      /**
+       * Hands one batch to work. Returns the number of elements used.
+       */
+      size_t run(){
+         typename A::span s = this->next();
+
+         if(s.length == 0){
+            return 0;
+         }
+
+         size_t used = func(s.addr, (size_t)s.length);
+         return this->done((used > s.length) ? s.length : used);
+      }
+
+   private:
+      F func;                          //Where the batches go.
+};
+
+/**
+ * Builds a stage without spelling out its types, so work can be a lambda:
+ * auto filter = ringStage(adc, packets, [](int16_t const *src, size_t n, ...){ ... });
+ */
+template<typename A, typename B, typename F>
+inline RingStage<A, B, F> ringStage(A &input, B &output, F work, size_t maxBatch = 0){
+   return RingStage<A, B, F>(input, output, work, maxBatch);
+}
+
+template<typename A, typename F>
+inline RingSink<A, F> ringSink(A &input, F work, size_t maxBatch = 0){
+   return RingSink<A, F>(input, work, maxBatch);
+}
+
+/**
+ * Runs each stage once, passed from the first to the last: ringRun(filter, packetizer, radio). The last stage runs
+ * first, so the room it frees is there for the stages before it. Returns the number of input elements used over all
+ * stages, 0 when the whole pipeline is idle or stalled.
+ */
+inline size_t ringRun(){
+   return 0;
+}
+
+template<typename S, typename... R>
+inline size_t ringRun(S &stage, R&... rest){
+   size_t later = ringRun(rest...);
+
+   return later + stage.run();
+}
+
+#endif
@@ -0,0 +1,306 @@
+#ifndef RTOS_RING_BUFFER_H
+#define RTOS_RING_BUFFER_H
+
+#include "RingBuffer.h"
+
+/**
+ * The kernel primitives RtosRingBuffer sleeps on: a binary semaphore per side, and the tick counter for timeouts.
+ * FreeRTOS is picked up when its header has already been included (as it is by Arduino.h on ESP32), and Zephyr when
+ * building under it. Defining RB_RTOS_POSIX, which is meant for the host tests only, stands POSIX semaphores and a
+ * millisecond clock in for the kernel.
+ */
+#if defined(__ZEPHYR__)
+   #include <zephyr/kernel.h>
+
+   typedef uint32_t ringTicks;
+   #define RB_WAIT_FOREVER       0xFFFFFFFFUL
+
+   struct ringSignal{
+      struct k_sem sem;
+
+      inline void begin(){
+         k_sem_init(&sem, 0, 1);
+      }
+
+      inline uint8_t wait(ringTicks ticks){
+         return k_sem_take(&sem, (ticks == RB_WAIT_FOREVER) ? K_FOREVER : K_TICKS(ticks)) == 0;
+      }
+
+      inline void give(){
+         k_sem_give(&sem);
+      }
+
+      inline void giveFromISR(){
+         k_sem_give(&sem);
+      }
+
+      static inline ringTicks now(){
+         return (ringTicks)k_uptime_ticks();
+      }
+   };
+#elif defined(INC_FREERTOS_H)
+   #if defined(ESP_PLATFORM)
+      #include "freertos/semphr.h"
+   #else
+      #include "semphr.h"
+   #endif
+
+   typedef TickType_t ringTicks;
+   #define RB_WAIT_FOREVER       portMAX_DELAY
+
+   struct ringSignal{
+      SemaphoreHandle_t sem;
+   #if configSUPPORT_STATIC_ALLOCATION
+      StaticSemaphore_t store;         //Keeps the semaphore off of the heap.
+   #endif
+
+      inline void begin(){
+   #if configSUPPORT_STATIC_ALLOCATION
+         sem = xSemaphoreCreateBinaryStatic(&store);
+   #else
+         sem = xSemaphoreCreateBinary();
+   #endif
+      }
+
+      inline uint8_t wait(ringTicks ticks){
+         return xSemaphoreTake(sem, ticks) == pdTRUE;
+      }
+
+      inline void give(){
+         xSemaphoreGive(sem);
+      }
+
+      inline void giveFromISR(){
+         BaseType_t woken = pdFALSE;
+         xSemaphoreGiveFromISR(sem, &woken);
+         portYIELD_FROM_ISR(woken);
+      }
+
+      static inline ringTicks now(){
+         return xTaskGetTickCount();
+      }
+   };
+#elif defined(RB_RTOS_POSIX)
+   #include <errno.h>
+   #include <semaphore.h>
+   #include <time.h>
+
+   typedef uint32_t ringTicks;         //Milliseconds.
+   #define RB_WAIT_FOREVER       0xFFFFFFFFUL
+
+   struct ringSignal{
+      sem_t sem;
+
+      inline void begin(){
+         sem_init(&sem, 0, 0);
+      }
+
+      inline uint8_t wait(ringTicks ticks){
+         if(ticks == RB_WAIT_FOREVER){
+            while(sem_wait(&sem) != 0 && errno == EINTR){
+            }
+            return 1;
+         }
+
+         struct timespec until;
+         clock_gettime(CLOCK_REALTIME, &until);
+         until.tv_sec += ticks / 1000;
+         until.tv_nsec += (long)(ticks % 1000) * 1000000;
+         if(until.tv_nsec >= 1000000000){
+            until.tv_sec++;
+            until.tv_nsec -= 1000000000;
+         }
+
+         int ret;
+         while((ret = sem_timedwait(&sem, &until)) != 0 && errno == EINTR){
+         }
+         return ret == 0;
+      }
+
+      inline void give(){
+         int count;
+         sem_getvalue(&sem, &count);
+         if(count == 0){
+            sem_post(&sem);             //Only one side gives each semaphore, so it stays binary.
+         }
+      }
+
+      inline void giveFromISR(){
+         give();
+      }
+
+      static inline ringTicks now(){
+         struct timespec ts;
+
+         clock_gettime(CLOCK_MONOTONIC, &ts);
+         return (ringTicks)((uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u);
+      }
+   };
+#else
+   #error "RtosRingBuffer needs FreeRTOS or Zephyr. Include FreeRTOS.h before this header."
+#endif
+
+/**
+ * A RingBuffer for RTOS tasks that sleep while there is nothing to do, instead of polling isEmpty() and isFull().
+ * readWait() blocks the reader until a value arrives, and writeWait() blocks the writer until there is room, each up
+ * to a timeout in ticks (RB_WAIT_FOREVER to wait indefinitely).
+ *
+ * Values still move through the lock-free single producer, single consumer paths. A side only touches the kernel when
+ * the other is asleep on it, which can only happen on an empty buffer for the reader and a full one for the writer:
+ * every other write and read costs one extra flag check. The waiting side raises its flag before looking at the
+ * buffer a last time, so a value that lands in between still wakes it.
+ *
+ * Call begin() once, after the scheduler's primitives can be created and before the first read or write. The
+ * FromISR() variants never block, and wake a sleeping task without waiting on anything.
+ */
+template<typename T, size_t N>
+class RtosRingBuffer{
+   public:
+      /**
+       * Creates the semaphores. Must be called before the buffer is used.
+       */
+      void begin(){
+         readerWaiting = 0;
+         writerWaiting = 0;
+         dataReady.begin();
+         roomReady.begin();
+      }
+
+      /**
+       * Stores a copy of data, waiting up to ticks for room when the buffer is full. Returns 1 when it was stored, and
+       * 0 when the time ran out. Only call from the producer task.
+       */
+      uint8_t writeWait(T const &data, ringTicks ticks = RB_WAIT_FOREVER){
+         ringTicks start = ringSignal::now();
+
+         while(ring.emplace(data) == ring.writeError){
+            ringStore(writerWaiting, (uint8_t)1);
+            RB_BARRIER();                       //The flag has to be visible before the last look at the buffer.
+            if(!ring.isFull()){
+               ringStore(writerWaiting, (uint8_t)0);
+               continue;
+            }
+
+            ringTicks spent = ringSignal::now() - start;
+            uint8_t woken = (ticks == RB_WAIT_FOREVER) ? roomReady.wait(ticks) :
+                            (spent < ticks && roomReady.wait(ticks - spent));
+            ringStore(writerWaiting, (uint8_t)0);
+            if(!woken){
+               return 0;
+            }
+         }
+
+         wakeReader(0);
+         return 1;
+      }
+
+      /**
+       * Moves the oldest value into dst, waiting up to ticks for one when the buffer is empty. Returns 1 when a value
+       * was read, and 0, leaving dst untouched, when the time ran out. Only call from the consumer task.
+       */
+      uint8_t readWait(T &dst, ringTicks ticks = RB_WAIT_FOREVER){
+         ringTicks start = ringSignal::now();
+
+         while(!ring.pop(dst)){
+            ringStore(readerWaiting, (uint8_t)1);
+            RB_BARRIER();                       //The flag has to be visible before the last look at the buffer.
+            if(!ring.isEmpty()){
+               ringStore(readerWaiting, (uint8_t)0);
+               continue;
+            }
+
+            ringTicks spent = ringSignal::now() - start;
+            uint8_t woken = (ticks == RB_WAIT_FOREVER) ? dataReady.wait(ticks) :
+                            (spent < ticks && dataReady.wait(ticks - spent));
+            ringStore(readerWaiting, (uint8_t)0);
+            if(!woken){
+               return 0;
+            }
+         }
+
+         wakeWriter(0);
+         return 1;
+      }
+
+      /**
+       * Stores a copy of data without waiting, from a task. Returns 0 when the buffer is full.
+       */
+      inline uint8_t write(T const &data){
+         if(ring.emplace(data) == ring.writeError){
+            return 0;
+         }
+         wakeReader(0);
+         return 1;
+      }
+
+      /**
+       * Stores a copy of data without waiting, from an ISR. Returns 0 when the buffer is full.
+       */
+      inline uint8_t writeFromISR(T const &data){
+         if(ring.emplace(data) == ring.writeError){
+            return 0;
+         }
+         wakeReader(1);
+         return 1;
+      }
+
+      /**
+       * Moves the oldest value into dst without waiting, from a task. Returns 0 when the buffer is empty.
+       */
+      inline uint8_t read(T &dst){
+         if(!ring.pop(dst)){
+            return 0;
+         }
+         wakeWriter(0);
+         return 1;
+      }
+
+      /**
+       * Moves the oldest value into dst without waiting, from an ISR. Returns 0 when the buffer is empty.
+       */
+      inline uint8_t readFromISR(T &dst){
+         if(!ring.pop(dst)){
+            return 0;
+         }
+         wakeWriter(1);
+         return 1;
+      }
+
+      inline uint8_t isFull() const{
+         return ring.isFull();
+      }
+
+      inline uint8_t isEmpty() const{
+         return ring.isEmpty();
+      }
+
+   private:
+      /**
+       * Wakes the reader if it is asleep on an empty buffer. Called after every write, and only reaches the kernel
+       * when the reader raised its flag.
+       */
+      inline void wakeReader(uint8_t isr){
+         RB_BARRIER();                          //The new index has to be visible before looking at the flag.
+         if(__builtin_expect(ringLoad(readerWaiting), 0)){
+            isr ? dataReady.giveFromISR() : dataReady.give();
+         }
+      }
+
+      /**
+       * Wakes the writer if it is asleep on a full buffer.
+       */
+      inline void wakeWriter(uint8_t isr){
+         RB_BARRIER();
+         if(__builtin_expect(ringLoad(writerWaiting), 0)){
+            isr ? roomReady.giveFromISR() : roomReady.give();
+         }
+      }
+
+      RingBuffer<T, 0, N, ReturnError> ring;   //The values, moved without locks.
+      ringSignal dataReady;                     //Given when a value lands while the reader waits.
+      ringSignal roomReady;                     //Given when room is made while the writer waits.
+      volatile uint8_t readerWaiting;           //Set by the reader while it sleeps on an empty buffer.
+      volatile uint8_t writerWaiting;           //Set by the writer while it sleeps on a full buffer.
+};
+
+#endif
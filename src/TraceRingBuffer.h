@@ -0,0 +1,104 @@
+#ifndef TRACE_RING_BUFFER_H
+#define TRACE_RING_BUFFER_H
+
+#include "RingBuffer.h"
+
+/**
+ * The clock trace records are stamped with. Defaults to micros() on Arduino, and to the microseconds of the monotonic
+ * clock on POSIX hosts; define it before including this header for a finer or cheaper source, such as DWT->CYCCNT on
+ * Cortex-M or TCNT1 on AVR with Timer1 left running. Anywhere else it has to be defined.
+ */
+#ifndef RB_TRACE_CLOCK
+   #if defined(ARDUINO)
+      #define RB_TRACE_CLOCK()   micros()
+   #elif defined(__unix__) || defined(__APPLE__)
+      #include <time.h>
+
+      inline uint32_t ringMicros(){
+         struct timespec ts;
+
+         clock_gettime(CLOCK_MONOTONIC, &ts);
+         return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u);
+      }
+
+      #define RB_TRACE_CLOCK()   ringMicros()
+   #else
+      #error "TraceRingBuffer needs a clock. Define RB_TRACE_CLOCK() before including this header."
+   #endif
+#endif
+
+/**
+ * Without a lock (RB_LOCKS 0) an ISR recording while a task records corrupts the ring, as OverwriteOldest moves the read
+ * index from the writing side. Such targets have to either define RB_LOCK (see RingBuffer.h), or define
+ * RB_TRACE_UNLOCKED to promise that records only ever come from one context at a time.
+ */
+#if !RB_LOCKS && !defined(RB_TRACE_UNLOCKED)
+   #error "TraceRingBuffer has no lock for this target. Define RB_LOCK, or RB_TRACE_UNLOCKED to record from one context."
+#endif
+
+/**
+ * Records an event in a TraceRingBuffer: RB_TRACE(trace, EV_RX_ISR_ENTER). The clock is read and the record stored
+ * inline, with nothing but the lock around the write.
+ */
+#define RB_TRACE(trace, id)      (trace).record(id)
+
+/**
+ * A single trace record: when it happened, and which event it was.
+ */
+template<typename E, typename S>
+struct traceRecord{
+   S time;                             //The clock at the time of the event.
+   E id;                               //Which event it was.
+};
+
+/**
+ * A flight recorder for profiling ISRs and tasks in the field. Keeps the last N events, each an event id and a
+ * timestamp, overwriting the oldest as new ones come in, so the run up to a fault or a slow path is still there to
+ * dump afterwards.
+ *
+ * Built on RingBuffer with an array of records stored inside the object, so size(), the iterators and read(dst, n)
+ * work as usual. E is the event id type and S the timestamp type; a uint8_t id with a uint16_t timestamp keeps a
+ * record at 3 bytes on AVR.
+ */
+template<size_t N, typename E = uint8_t, typename S = uint32_t>
+class TraceRingBuffer : public RingBuffer<traceRecord<E, S>, 0, N, OverwriteOldest>{
+   public:
+      typedef traceRecord<E, S> record_t;
+
+      /**
+       * Stores an event stamped with RB_TRACE_CLOCK(), inside RB_LOCK. Safe to call from ISRs and tasks alike
+       * wherever RB_LOCKS is not 0: AVR, Cortex-M and ESP32 out of the box.
+       */
+      inline void record(E id){
+         record_t r = {(S)RB_TRACE_CLOCK(), id};
+
+         RB_LOCK(state);
+         this->write(&r);
+         RB_UNLOCK(state);
+      }
+
+      /**
+       * Prints and removes every record, oldest first, one "time id" line each, such as dump(Serial). Records are
+       * read out in blocks with interrupts held off, and printed with them back on. Takes anything with Print's
+       * print() and println(), so host builds can dump too.
+       */
+      template<typename O>
+      void dump(O &out){
+         record_t block[8];
+         size_t n;
+
+         do{
+            RB_LOCK(state);
+            n = this->read(block, sizeof(block) / sizeof(block[0]));
+            RB_UNLOCK(state);
+
+            for(size_t i = 0; i < n; i++){
+               out.print((unsigned long)block[i].time);
+               out.print(' ');
+               out.println((unsigned long)block[i].id);
+            }
+         }while(n);
+      }
+};
+
+#endif
@@ -0,0 +1,216 @@
+#ifndef WINDOW_RING_BUFFER_H
+#define WINDOW_RING_BUFFER_H
+
+#include "RingBuffer.h"
+
+/**
+ * Aggregates a WindowRingBuffer keeps on top of the running sum, passed as its third template argument.
+ */
+#define RB_WINDOW_SUM      0
+#define RB_WINDOW_MIN      1
+#define RB_WINDOW_MAX      2
+#define RB_WINDOW_MINMAX   (RB_WINDOW_MIN | RB_WINDOW_MAX)
+
+/**
+ * Picks the type the running sum of a window is kept in. Integers narrower than 32 bits are summed in a 32 bit integer
+ * of the same signedness and 32 bit integers in a 64 bit one, so a window of N samples can't overflow it; 64 bit
+ * integers are summed in their own type. float is summed in double, so a large sample leaving the window takes no
+ * small ones with it, and wider floating point types in their own type.
+ */
+template<typename T>
+struct ringSum{
+   typedef typename ringSelect<((T)1 / 2 != 0), typename ringSelect<(sizeof(T) < sizeof(double)), double, T>::type,
+           typename ringSelect<(sizeof(T) >= 8), T,
+           typename ringSelect<(sizeof(T) >= 4),
+                               typename ringSelect<((T)-1 < 0), int64_t, uint64_t>::type,
+                               typename ringSelect<((T)-1 < 0), int32_t, uint32_t>::type>::type>::type>::type type;
+};
+
+/**
+ * A sliding window over the last N values written, such as a moving average over sensor readings. write() overwrites
+ * the oldest value once the window is full, and the running sum is updated with the value going in and the value
+ * going out, so sum() and mean() never scan the array.
+ *
+ * A floating point sum rounds on every add and subtract, and those errors would add up over a long run. So once the
+ * window is full, a floating point S is summed again from the window every N writes, which keeps the drift to what
+ * about 2N roundings can make, at the cost of one pass over the window per N writes.
+ *
+ * Passing RB_WINDOW_MIN, RB_WINDOW_MAX or RB_WINDOW_MINMAX also keeps min() and max(), each with a monotonic queue of
+ * the values that can still become the extreme of the window. Every value enters and leaves a queue once, so a write
+ * stays constant time on average, at the cost of N indices per queue.
+ *
+ * The window is meant to be written and queried from the same context. To feed it from an ISR, hand the samples over
+ * through a RingBuffer with p_write() and p_read() first.
+ */
+template<typename T, size_t N, uint8_t track = RB_WINDOW_SUM, typename S = typename ringSum<T>::type,
+         typename I = typename ringIndex<N>::type>
+class WindowRingBuffer{
+   static_assert(N != 0, "WindowRingBuffer needs a compile-time capacity.");
+   typedef ringWrap<N, I> wrap;
+
+   public:
+      /**
+       * Construct a new, empty Window Ring Buffer object. The array is stored inside the object.
+       */
+      WindowRingBuffer(){
+         clear();
+      };
+
+      /**
+       * Adds a value to the window, dropping the oldest one when the window is full.
+       */
+      void write(T data){
+         if(__builtin_expect(used == N, 1)){
+            T old = addr[wrap::slot(readPos)];
+            if((S)1 / 2 != 0 && ++evicted == N){
+               evicted = 0;
+               resum();                         //Drops the rounding the running sum has picked up.
+            }
+            total -= (S)old;
+            if(track & RB_WINDOW_MIN){
+               lows.evict(readPos);
+            }
+            if(track & RB_WINDOW_MAX){
+               highs.evict(readPos);
+            }
+            readPos = wrap::next(readPos);
+         }else{
+            used++;
+         }
+
+         addr[wrap::slot(writePos)] = data;
+         total += (S)data;
+         if(track & RB_WINDOW_MIN){
+            lows.push(writePos, data, addr);
+         }
+         if(track & RB_WINDOW_MAX){
+            highs.push(writePos, data, addr);
+         }
+         writePos = wrap::next(writePos);
+      }
+
+      /**
+       * Returns the sum of the values in the window.
+       */
+      inline S sum() const{
+         return total;
+      }
+
+      /**
+       * Returns the average of the values in the window, or 0 when it is empty. Divides once per call.
+       */
+      inline S mean() const{
+         return used ? total / (S)used : 0;
+      }
+
+      /**
+       * Returns the smallest value in the window. The window must not be empty.
+       */
+      inline T min() const{
+         static_assert(track & RB_WINDOW_MIN, "min() needs RB_WINDOW_MIN as the third template argument.");
+         return addr[wrap::slot(lows.front())];
+      }
+
+      /**
+       * Returns the largest value in the window. The window must not be empty.
+       */
+      inline T max() const{
+         static_assert(track & RB_WINDOW_MAX, "max() needs RB_WINDOW_MAX as the third template argument.");
+         return addr[wrap::slot(highs.front())];
+      }
+
+      /**
+       * Returns the number of values in the window, which stays at N once it has filled up.
+       */
+      inline I size() const{
+         return used;
+      }
+
+      /**
+       * Checks if the window holds N values.
+       */
+      inline uint8_t isFull() const{
+         return used == N;
+      }
+
+      /**
+       * Empties the window and zeroes the sum.
+       */
+      void clear(){
+         readPos = 0;
+         writePos = 0;
+         used = 0;
+         evicted = 0;
+         total = 0;
+         lows.clear();
+         highs.clear();
+      }
+
+   private:
+      /**
+       * Sums the window again from its values.
+       */
+      void resum(){
+         S fresh = 0;
+         for(I i = 0, pos = readPos; i < used; i++, pos = wrap::next(pos)){
+            fresh += (S)addr[wrap::slot(pos)];
+         }
+         total = fresh;
+      }
+
+      /**
+       * A monotonic queue of write indices, whose values only rise from front to back for min() (keep = 1) and only
+       * fall for max() (keep = 2). The front is always the extreme of the window. Write indices run over twice the
+       * capacity, so an entry is never mistaken for the value that later took over its slot. Holds a single unused
+       * entry when its aggregate isn't tracked.
+       */
+      template<uint8_t keep, size_t M>
+      struct extreme{
+         inline void push(I pos, T data, T const *values){
+            while(len && beaten(values[wrap::slot(at(len - 1))], data)){
+               len--;                           //Can never be the extreme again while data is in the window.
+            }
+            at(len++) = pos;
+         }
+
+         inline void evict(I pos){
+            if(len && at(0) == pos){
+               head = (head + 1 == M) ? 0 : head + 1;
+               len--;
+            }
+         }
+
+         inline I front() const{
+            return entries[head];
+         }
+
+         inline void clear(){
+            head = 0;
+            len = 0;
+         }
+
+         static inline uint8_t beaten(T queued, T data){
+            return (keep == RB_WINDOW_MIN) ? !(queued < data) : !(data < queued);
+         }
+
+         inline I &at(I i){
+            I e = head + i;
+            return entries[(e >= M) ? e - M : e];
+         }
+
+         I entries[M];
+         I head;
+         I len;
+      };
+
+      T addr[N];                       //The values in the window.
+      I readPos;                       //The index of the oldest value.
+      I writePos;                      //The index the next value is written to.
+      I used;                          //How many values are in the window.
+      I evicted;                       //Values dropped since a floating point sum was last summed again.
+      S total;                         //The running sum of the window.
+      extreme<RB_WINDOW_MIN, (track & RB_WINDOW_MIN) ? N : 1> lows;
+      extreme<RB_WINDOW_MAX, (track & RB_WINDOW_MAX) ? N : 1> highs;
+};
+
+#endif